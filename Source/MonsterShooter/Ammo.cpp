@@ -2,6 +2,7 @@
 
 
 #include "Ammo.h"
+#include "MonsterShooter.h"
 #include "Components/BoxComponent.h"
 #include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
@@ -21,6 +22,9 @@ AAmmo::AAmmo()
   AmmoCollisionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AmmoCollisionSphere"));
   AmmoCollisionSphere->SetupAttachment(GetRootComponent());
   AmmoCollisionSphere->SetSphereRadius(50.f);
+  // Pickup overlaps only, bullets and item traces go through
+  AmmoCollisionSphere->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
+  AmmoCollisionSphere->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Ignore);
 }
 
 void AAmmo::Tick(float DeltaTime)
@@ -5,6 +5,7 @@ enum class EAmmoType : uint8
 {
   EAT_9mm UMETA(DisplayName = "9mm"),
   EAT_AssaultRifle UMETA(DisplayName = "AssaultRifle"),
+  EAT_Grenade UMETA(DisplayName = "Grenade"),
 
   EAT_MAX UMETA(DisplayName = "DefaultMAX")
 };
\ No newline at end of file
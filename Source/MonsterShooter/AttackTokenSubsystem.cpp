@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AttackTokenSubsystem.h"
+#include "Enemy.h"
+
+static TAutoConsoleVariable<int32> CVarAttackTokensPerTarget(
+    TEXT("MonsterShooter.AI.AttackTokensPerTarget"),
+    4,
+    TEXT("Maximum number of enemies attacking the same target at once, whatever their type."),
+    ECVF_Default);
+
+bool UAttackTokenSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UAttackTokenSubsystem::GetSlotsPerTarget(EEnemyType EnemyType)
+{
+  switch (EnemyType)
+  {
+  case EEnemyType::EET_Grux:
+    return 2;
+  case EEnemyType::EET_Warchief:
+    return 1;
+  case EEnemyType::EET_Gruxling:
+    return 3;
+  case EEnemyType::EET_Qilin:
+    return 1;
+  }
+
+  return 1;
+}
+
+void UAttackTokenSubsystem::RequestToken(AEnemy *Enemy, AActor *Target)
+{
+  if (!Enemy || !Target)
+    return;
+
+  // Already holding or waiting for this target
+  if (const FAttackTokenPool *CurrentPool = Pools.Find(Target))
+  {
+    if (CurrentPool->Holders.Contains(Enemy) || CurrentPool->Waiting.Contains(Enemy))
+      return;
+  }
+
+  // An enemy only attacks one target at a time
+  ReleaseToken(Enemy);
+
+  FAttackTokenPool &Pool = Pools.FindOrAdd(Target);
+  PrunePool(Pool);
+
+  if (HasFreeToken(Pool, Enemy))
+  {
+    Pool.Holders.Add(Enemy);
+    Enemy->SetHasAttackToken(true);
+    return;
+  }
+
+  // Warchiefs take over the token of the lesser enemy that has held one the longest
+  if (Enemy->GetEnemyType() == EEnemyType::EET_Warchief)
+  {
+    int32 WarchiefHolders = 0;
+    for (const TWeakObjectPtr<AEnemy> &Holder : Pool.Holders)
+    {
+      WarchiefHolders += Holder->GetEnemyType() == EEnemyType::EET_Warchief ? 1 : 0;
+    }
+
+    const int32 RevokedIndex = Pool.Holders.IndexOfByPredicate([](const TWeakObjectPtr<AEnemy> &Holder)
+                                                               { return Holder->GetEnemyType() != EEnemyType::EET_Warchief; });
+    if (RevokedIndex != INDEX_NONE && WarchiefHolders < GetSlotsPerTarget(EEnemyType::EET_Warchief))
+    {
+      AEnemy *Revoked = Pool.Holders[RevokedIndex].Get();
+      Pool.Holders.RemoveAt(RevokedIndex);
+      Revoked->SetHasAttackToken(false);
+      // Gets the next free token
+      Pool.Waiting.Insert(Revoked, 0);
+
+      Pool.Holders.Add(Enemy);
+      Enemy->SetHasAttackToken(true);
+      return;
+    }
+  }
+
+  Pool.Waiting.Add(Enemy);
+}
+
+void UAttackTokenSubsystem::ReleaseToken(AEnemy *Enemy)
+{
+  for (auto It = Pools.CreateIterator(); It; ++It)
+  {
+    FAttackTokenPool &Pool = It.Value();
+    Pool.Waiting.Remove(Enemy);
+
+    if (Pool.Holders.Remove(Enemy) > 0)
+    {
+      Enemy->SetHasAttackToken(false);
+      GrantWaiting(Pool);
+    }
+
+    if (!It.Key().IsValid() || (Pool.Holders.Num() == 0 && Pool.Waiting.Num() == 0))
+    {
+      It.RemoveCurrent();
+    }
+  }
+}
+
+bool UAttackTokenSubsystem::HasFreeToken(const FAttackTokenPool &Pool, const AEnemy *Enemy) const
+{
+  if (Pool.Holders.Num() >= CVarAttackTokensPerTarget.GetValueOnGameThread())
+    return false;
+
+  const EEnemyType EnemyType = Enemy->GetEnemyType();
+  int32 SameTypeHolders = 0;
+  for (const TWeakObjectPtr<AEnemy> &Holder : Pool.Holders)
+  {
+    SameTypeHolders += Holder->GetEnemyType() == EnemyType ? 1 : 0;
+  }
+
+  return SameTypeHolders < GetSlotsPerTarget(EnemyType);
+}
+
+void UAttackTokenSubsystem::GrantWaiting(FAttackTokenPool &Pool)
+{
+  PrunePool(Pool);
+
+  // Waiting Warchiefs go first
+  Pool.Waiting.StableSort([](const TWeakObjectPtr<AEnemy> &A, const TWeakObjectPtr<AEnemy> &B)
+                          { return A->GetEnemyType() == EEnemyType::EET_Warchief && B->GetEnemyType() != EEnemyType::EET_Warchief; });
+
+  for (int32 i = 0; i < Pool.Waiting.Num();)
+  {
+    AEnemy *Enemy = Pool.Waiting[i].Get();
+    if (!HasFreeToken(Pool, Enemy))
+    {
+      i++;
+      continue;
+    }
+
+    Pool.Waiting.RemoveAt(i);
+    Pool.Holders.Add(Enemy);
+    Enemy->SetHasAttackToken(true);
+  }
+}
+
+void UAttackTokenSubsystem::PrunePool(FAttackTokenPool &Pool)
+{
+  auto IsGone = [](const TWeakObjectPtr<AEnemy> &Enemy)
+  { return !Enemy.IsValid() || Enemy->IsDead(); };
+
+  Pool.Holders.RemoveAll(IsGone);
+  Pool.Waiting.RemoveAll(IsGone);
+}
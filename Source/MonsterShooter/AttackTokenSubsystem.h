@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyType.h"
+#include "AttackTokenSubsystem.generated.h"
+
+class AEnemy;
+
+/** Attack tokens of one target */
+struct FAttackTokenPool
+{
+  /** Enemies allowed to attack the target */
+  TArray<TWeakObjectPtr<AEnemy>> Holders;
+
+  /** Enemies in range waiting for a token, in request order */
+  TArray<TWeakObjectPtr<AEnemy>> Waiting;
+};
+
+/**
+ * Limits how many enemies attack the same target at once. Enemies in attack range request a token for their
+ * target, and only token holders may attack. Each enemy type has its own number of slots per target,
+ * on top of a total per target, and a Warchief takes a token from a lesser enemy when none is free.
+ * Released tokens go to the waiting enemies in request order
+ */
+UCLASS()
+class MONSTERSHOOTER_API UAttackTokenSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  /** Gives Enemy a token for Target, or queues it until one is released */
+  void RequestToken(AEnemy *Enemy, AActor *Target);
+
+  /** Gives back the token of Enemy, or leaves the queue, and hands free tokens to the waiting enemies */
+  void ReleaseToken(AEnemy *Enemy);
+
+  /** Attackers of one enemy type allowed on the same target */
+  static int32 GetSlotsPerTarget(EEnemyType EnemyType);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** If Enemy fits in the free tokens of Pool */
+  bool HasFreeToken(const FAttackTokenPool &Pool, const AEnemy *Enemy) const;
+
+  /** Hands free tokens of Pool to its waiting enemies */
+  void GrantWaiting(FAttackTokenPool &Pool);
+
+  /** Forgets destroyed and dead enemies */
+  void PrunePool(FAttackTokenPool &Pool);
+
+  TMap<TWeakObjectPtr<AActor>, FAttackTokenPool> Pools;
+};
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTTask_FollowFlowField.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "FlowFieldSubsystem.h"
+
+UBTTask_FollowFlowField::UBTTask_FollowFlowField() : AcceptableRadius(150.f)
+{
+  NodeName = TEXT("Follow Flow Field");
+  bNotifyTick = true;
+  bNotifyTaskFinished = true;
+
+  BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FollowFlowField, BlackboardKey), AActor::StaticClass());
+}
+
+EBTNodeResult::Type UBTTask_FollowFlowField::ExecuteTask(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory)
+{
+  FBTFollowFlowFieldMemory *Memory = reinterpret_cast<FBTFollowFlowFieldMemory *>(NodeMemory);
+  Memory->bPathfinding = false;
+
+  AAIController *Controller = OwnerComp.GetAIOwner();
+  APawn *Pawn = Controller ? Controller->GetPawn() : nullptr;
+  AActor *Target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(BlackboardKey.GetSelectedKeyID()));
+  if (!Pawn || !Target)
+    return EBTNodeResult::Failed;
+
+  if (Pawn->GetDistanceTo(Target) <= AcceptableRadius)
+    return EBTNodeResult::Succeeded;
+
+  // A move requested before the task would fight the steering of the field
+  Controller->StopMovement();
+
+  if (auto FlowField = GetWorld()->GetSubsystem<UFlowFieldSubsystem>())
+  {
+    FlowField->StartFollowing(Pawn, Target);
+  }
+
+  return EBTNodeResult::InProgress;
+}
+
+void UBTTask_FollowFlowField::TickTask(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory, float DeltaSeconds)
+{
+  FBTFollowFlowFieldMemory *Memory = reinterpret_cast<FBTFollowFlowFieldMemory *>(NodeMemory);
+
+  AAIController *Controller = OwnerComp.GetAIOwner();
+  APawn *Pawn = Controller ? Controller->GetPawn() : nullptr;
+  AActor *Target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(BlackboardKey.GetSelectedKeyID()));
+  auto FlowField = GetWorld()->GetSubsystem<UFlowFieldSubsystem>();
+  if (!Pawn || !Target || !FlowField)
+  {
+    FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+    return;
+  }
+
+  if (Pawn->GetDistanceTo(Target) <= AcceptableRadius)
+  {
+    FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+    return;
+  }
+
+  // The target may have changed since the task started
+  FlowField->StartFollowing(Pawn, Target);
+
+  // The subsystem steers pawns inside the field, a regular path takes over outside of it
+  const bool bInField = FlowField->IsInField(Pawn);
+  if (bInField && Memory->bPathfinding)
+  {
+    Controller->StopMovement();
+    Memory->bPathfinding = false;
+  }
+  else if (!bInField && !Memory->bPathfinding)
+  {
+    Controller->MoveToActor(Target, AcceptableRadius);
+    Memory->bPathfinding = true;
+  }
+}
+
+void UBTTask_FollowFlowField::OnTaskFinished(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory, EBTNodeResult::Type TaskResult)
+{
+  FBTFollowFlowFieldMemory *Memory = reinterpret_cast<FBTFollowFlowFieldMemory *>(NodeMemory);
+
+  AAIController *Controller = OwnerComp.GetAIOwner();
+  if (Controller)
+  {
+    if (auto FlowField = GetWorld()->GetSubsystem<UFlowFieldSubsystem>())
+    {
+      FlowField->StopFollowing(Controller->GetPawn());
+    }
+
+    if (Memory->bPathfinding)
+    {
+      Controller->StopMovement();
+    }
+  }
+  Memory->bPathfinding = false;
+
+  Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+}
+
+uint16 UBTTask_FollowFlowField::GetInstanceMemorySize() const
+{
+  return sizeof(FBTFollowFlowFieldMemory);
+}
+
+FString UBTTask_FollowFlowField::GetStaticDescription() const
+{
+  return FString::Printf(TEXT("%s: %s\nAcceptable radius: %.0f"), *Super::GetStaticDescription(), *GetSelectedBlackboardKey().ToString(), AcceptableRadius);
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "BTTask_FollowFlowField.generated.h"
+
+/** Instance memory of the follow flow field task */
+struct FBTFollowFlowFieldMemory
+{
+  /** If the pawn is outside the field and moved by a regular path request */
+  bool bPathfinding;
+};
+
+/**
+ * Chases the actor of the blackboard key through the shared flow field of that actor, without a path query
+ * per enemy. Falls back to a regular move to the actor while the pawn is outside the field.
+ * Succeeds once within AcceptableRadius of the actor
+ */
+UCLASS()
+class MONSTERSHOOTER_API UBTTask_FollowFlowField : public UBTTask_BlackboardBase
+{
+  GENERATED_BODY()
+
+public:
+  UBTTask_FollowFlowField();
+
+  virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory) override;
+  virtual void OnTaskFinished(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory, EBTNodeResult::Type TaskResult) override;
+  virtual uint16 GetInstanceMemorySize() const override;
+  virtual FString GetStaticDescription() const override;
+
+protected:
+  virtual void TickTask(UBehaviorTreeComponent &OwnerComp, uint8 *NodeMemory, float DeltaSeconds) override;
+
+private:
+  /** Distance to the target at which the task succeeds */
+  UPROPERTY(EditAnywhere, Category = "Flow Field", meta = (ClampMin = "0.0"))
+  float AcceptableRadius;
+};
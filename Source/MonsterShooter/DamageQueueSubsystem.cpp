@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DamageQueueSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "WorldCollision.h"
+#include "Enemy.h"
+
+void UDamageQueueSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  FlushDamage();
+}
+
+TStatId UDamageQueueSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageQueueSubsystem, STATGROUP_Tickables);
+}
+
+bool UDamageQueueSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FPendingDamage &UDamageQueueSubsystem::FindOrAddPending(AActor *Victim, AController *EventInstigator, AActor *DamageCauser)
+{
+  FPendingDamage &Pending = PendingDamage.FindOrAdd(Victim);
+  Pending.EventInstigator = EventInstigator;
+  Pending.DamageCauser = DamageCauser;
+
+  return Pending;
+}
+
+void UDamageQueueSubsystem::QueueDamage(AActor *Victim, float Damage, AController *EventInstigator, AActor *DamageCauser)
+{
+  if (!Victim || Damage <= 0.f)
+    return;
+
+  FindOrAddPending(Victim, EventInstigator, DamageCauser).Damage += Damage;
+}
+
+void UDamageQueueSubsystem::QueueBulletDamage(
+    AEnemy *Victim,
+    float Damage,
+    float BalanceDamage,
+    const FVector &HitLocation,
+    bool bWeakspot,
+    AController *EventInstigator,
+    AActor *DamageCauser)
+{
+  if (!Victim || Damage <= 0.f)
+    return;
+
+  FPendingDamage &Pending = FindOrAddPending(Victim, EventInstigator, DamageCauser);
+  Pending.Damage += Damage;
+  Pending.BulletDamage += Damage;
+  Pending.BalanceDamage += BalanceDamage;
+  Pending.HitLocation = HitLocation;
+  Pending.bWeakspot |= bWeakspot;
+}
+
+void UDamageQueueSubsystem::QueueRadialDamage(
+    float BaseDamage,
+    float MinimumDamage,
+    const FVector &Origin,
+    float InnerRadius,
+    float OuterRadius,
+    float DamageFalloff,
+    AActor *DamageCauser,
+    AController *EventInstigator)
+{
+  UWorld *World = GetWorld();
+  if (!World || OuterRadius <= 0.f)
+    return;
+
+  FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RadialDamage), false, DamageCauser);
+
+  TArray<FOverlapResult> Overlaps;
+  World->OverlapMultiByObjectType(
+      Overlaps,
+      Origin,
+      FQuat::Identity,
+      FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects),
+      FCollisionShape::MakeSphere(OuterRadius),
+      QueryParams);
+
+  // Closest visible distance to the origin for each actor
+  TMap<AActor *, float> VictimDistances;
+  for (const FOverlapResult &Overlap : Overlaps)
+  {
+    AActor *Victim = Overlap.GetActor();
+    UPrimitiveComponent *Component = Overlap.GetComponent();
+    if (!Victim || !Component || !Victim->CanBeDamaged())
+      continue;
+
+    // Only damage components that can be seen from the origin
+    FHitResult BlockingHit;
+    const FVector ComponentCenter = Component->Bounds.Origin;
+    if (World->LineTraceSingleByChannel(BlockingHit, Origin, ComponentCenter, ECollisionChannel::ECC_Visibility, QueryParams) &&
+        BlockingHit.GetActor() != Victim)
+    {
+      continue;
+    }
+
+    FVector ClosestPoint;
+    float Distance = Component->GetClosestPointOnCollision(Origin, ClosestPoint);
+    if (Distance < 0.f)
+    {
+      Distance = FVector::Dist(Origin, ComponentCenter);
+    }
+
+    float *VictimDistance = VictimDistances.Find(Victim);
+    if (!VictimDistance)
+    {
+      VictimDistances.Add(Victim, Distance);
+    }
+    else if (Distance < *VictimDistance)
+    {
+      *VictimDistance = Distance;
+    }
+  }
+
+  const FRadialDamageParams DamageParams(BaseDamage, MinimumDamage, InnerRadius, OuterRadius, DamageFalloff);
+  for (const TPair<AActor *, float> &VictimDistance : VictimDistances)
+  {
+    const float DamageScale = DamageParams.GetDamageScale(VictimDistance.Value);
+    const float Damage = FMath::Lerp(MinimumDamage, BaseDamage, FMath::Max(0.f, DamageScale));
+
+    QueueDamage(VictimDistance.Key, Damage, EventInstigator, DamageCauser);
+  }
+}
+
+void UDamageQueueSubsystem::FlushDamage()
+{
+  if (PendingDamage.Num() == 0)
+    return;
+
+  // Damage queued while applying goes to the next flush
+  TMap<TWeakObjectPtr<AActor>, FPendingDamage> DamageToApply = MoveTemp(PendingDamage);
+  PendingDamage.Reset();
+
+  for (const TPair<TWeakObjectPtr<AActor>, FPendingDamage> &Entry : DamageToApply)
+  {
+    AActor *Victim = Entry.Key.Get();
+    const FPendingDamage &Pending = Entry.Value;
+    if (!Victim)
+      continue;
+
+    AEnemy *HitEnemy = Cast<AEnemy>(Victim);
+    if (HitEnemy && HitEnemy->IsDead())
+      continue;
+
+    UGameplayStatics::ApplyDamage(
+        Victim,
+        Pending.Damage,
+        Pending.EventInstigator.Get(),
+        Pending.DamageCauser.Get(),
+        UDamageType::StaticClass());
+
+    if (HitEnemy && Pending.BulletDamage > 0.f)
+    {
+      HitEnemy->ShowHitNumber(FMath::TruncToInt32(Pending.BulletDamage), Pending.HitLocation, Pending.bWeakspot);
+      if (!HitEnemy->IsDead())
+      {
+        HitEnemy->TakeBalanceDamage(Pending.BalanceDamage);
+      }
+    }
+  }
+}
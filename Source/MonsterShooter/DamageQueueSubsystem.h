@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamageQueueSubsystem.generated.h"
+
+/** Damage dealt to a single victim during the current frame */
+struct FPendingDamage
+{
+  /** Total damage from every source */
+  float Damage = 0.f;
+
+  /** Part of the damage that came from bullets, shown as a single hit number */
+  float BulletDamage = 0.f;
+
+  /** Total balance damage from bullets */
+  float BalanceDamage = 0.f;
+
+  /** Location of the last bullet hit, where the hit number is shown */
+  FVector HitLocation = FVector::ZeroVector;
+
+  /** If any of the bullets hit a weakspot */
+  bool bWeakspot = false;
+
+  /** Instigator and causer of the last damage queued */
+  TWeakObjectPtr<AController> EventInstigator;
+  TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/**
+ * Collects every damage dealt during a frame and applies it once per victim at the end of the frame,
+ * so a victim hit many times only updates its health, health bar, hit number and blackboard once
+ */
+UCLASS()
+class MONSTERSHOOTER_API UDamageQueueSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Queues damage to be applied to the victim at the end of the frame */
+  void QueueDamage(AActor *Victim, float Damage, AController *EventInstigator, AActor *DamageCauser);
+
+  /** Queues a bullet hit on an enemy, shown as a hit number and applying balance damage if the enemy survives */
+  void QueueBulletDamage(
+      class AEnemy *Victim,
+      float Damage,
+      float BalanceDamage,
+      const FVector &HitLocation,
+      bool bWeakspot,
+      AController *EventInstigator,
+      AActor *DamageCauser);
+
+  /** Queues damage for every actor in the radius visible from the origin, falling off between the inner and outer radius */
+  void QueueRadialDamage(
+      float BaseDamage,
+      float MinimumDamage,
+      const FVector &Origin,
+      float InnerRadius,
+      float OuterRadius,
+      float DamageFalloff,
+      AActor *DamageCauser,
+      AController *EventInstigator);
+
+  /** Applies the damage queued so far, once per victim */
+  void FlushDamage();
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  FPendingDamage &FindOrAddPending(AActor *Victim, AController *EventInstigator, AActor *DamageCauser);
+
+  /** Damage queued this frame, by victim */
+  TMap<TWeakObjectPtr<AActor>, FPendingDamage> PendingDamage;
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DecalSubsystem.h"
+#include "Components/DecalComponent.h"
+#include "Materials/MaterialInterface.h"
+
+static TAutoConsoleVariable<float> CVarBulletHoleMergeRadius(
+    TEXT("MonsterShooter.FX.BulletHoleMergeRadius"),
+    6.f,
+    TEXT("Bullet holes closer than this to an existing one are not added."),
+    ECVF_Default);
+
+void UDecalSubsystem::Deinitialize()
+{
+  for (UDecalComponent *Decal : Decals)
+  {
+    if (IsValid(Decal))
+    {
+      Decal->DestroyComponent();
+    }
+  }
+  Decals.Empty();
+
+  Super::Deinitialize();
+}
+
+bool UDecalSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDecalSubsystem::AddBulletHole(const FHitResult &Hit, UMaterialInterface *Material, float Size)
+{
+  if (!Material || GetWorld()->IsNetMode(NM_DedicatedServer))
+    return;
+
+  // Moving geometry would leave the hole floating in the air
+  const UPrimitiveComponent *HitComponent = Hit.GetComponent();
+  if (!HitComponent || HitComponent->Mobility != EComponentMobility::Static)
+    return;
+
+  const float MergeRadius = CVarBulletHoleMergeRadius.GetValueOnGameThread();
+  const float MergeRadiusSquared = MergeRadius * MergeRadius;
+  for (const UDecalComponent *Decal : Decals)
+  {
+    if (FVector::DistSquared(Decal->GetComponentLocation(), Hit.ImpactPoint) <= MergeRadiusSquared)
+      return;
+  }
+
+  UDecalComponent *Decal = nullptr;
+  if (Decals.Num() < DecalCapacity)
+  {
+    Decal = CreateDecal();
+  }
+  else
+  {
+    // Full, recycle the oldest hole
+    Decal = Decals[NextSlot];
+    NextSlot = (NextSlot + 1) % DecalCapacity;
+  }
+
+  // Decals project along their X axis, into the surface, with a random spin so holes don't look alike
+  FRotator DecalRotation = (-Hit.ImpactNormal).Rotation();
+  DecalRotation.Roll = FMath::FRandRange(-180.f, 180.f);
+
+  Decal->SetDecalMaterial(Material);
+  Decal->DecalSize = FVector(Size, Size, Size);
+  Decal->SetWorldLocationAndRotation(Hit.ImpactPoint, DecalRotation);
+  Decal->MarkRenderStateDirty();
+}
+
+UDecalComponent *UDecalSubsystem::CreateDecal()
+{
+  UWorld *World = GetWorld();
+
+  UDecalComponent *Decal = NewObject<UDecalComponent>(World->GetWorldSettings());
+  Decal->SetAbsolute(true, true, true);
+  Decal->RegisterComponentWithWorld(World);
+
+  Decals.Add(Decal);
+  return Decal;
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DecalSubsystem.generated.h"
+
+class UDecalComponent;
+class UMaterialInterface;
+
+/**
+ * Bullet hole decals on static world geometry. Decal components are kept in a fixed size ring buffer,
+ * created on first use and then recycled oldest first, so the number of decals never grows past the capacity.
+ * Hits landing next to an existing hole reuse it instead of stacking a new decal
+ */
+UCLASS()
+class MONSTERSHOOTER_API UDecalSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Deinitialize() override;
+
+  /** Leaves a bullet hole of Size at Hit, only on static geometry */
+  void AddBulletHole(const FHitResult &Hit, UMaterialInterface *Material, float Size);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Creates the decal component of a ring buffer slot */
+  UDecalComponent *CreateDecal();
+
+  /** Maximum number of bullet holes in the world */
+  static constexpr int32 DecalCapacity = 128;
+
+  /** Ring buffer of decals, grows up to DecalCapacity then recycles */
+  UPROPERTY()
+  TArray<UDecalComponent *> Decals;
+
+  /** Slot of the next decal once the ring buffer is full */
+  int32 NextSlot = 0;
+};
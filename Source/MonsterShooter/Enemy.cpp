@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Enemy.h"
+#include "MonsterShooter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 
 #include "Kismet/GameplayStatics.h"
@@ -13,8 +14,18 @@
 #include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/BoxComponent.h"
 #include "HealthComponent.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "DamageQueueSubsystem.h"
+#include "LagCompensationSubsystem.h"
+#include "FXPoolSubsystem.h"
+#include "ImpactFXSubsystem.h"
+#include "ImpactSignificanceSubsystem.h"
+#include "EnemyAudioSubsystem.h"
+#include "EnemyLODSubsystem.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "AttackTokenSubsystem.h"
+#include "MeleeSweepSubsystem.h"
 
 // Sets default values
 AEnemy::AEnemy() : HealthBarDisplayTime(4.f),
@@ -30,13 +41,18 @@ AEnemy::AEnemy() : HealthBarDisplayTime(4.f),
                    AttackLFast(TEXT("AttackLFast")),
                    AttackRFast(TEXT("AttackRFast")),
                    RushAttackSection(TEXT("RushAttack")),
+                   LeftWeaponBone(TEXT("LeftWeaponBone")),
+                   RightWeaponBone(TEXT("RightWeaponBone")),
+                   MeleeWeaponRadius(25.f),
                    BasicAttackDamage(20.f),
                    bCanAttack(true),
+                   bHasAttackToken(false),
                    AttackWaitTime(1.f),
                    bDead(false),
                    EnemyState(EEnemyState::EES_Unoccupied),
                    BaseMovementSpeed(400.0f),
-                   EnemyType(EEnemyType::EET_Grux)
+                   EnemyType(EEnemyType::EET_Grux),
+                   AILODTier(EEnemyLOD::EEL_Full)
 {
   // Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
   PrimaryActorTick.bCanEverTick = true;
@@ -45,19 +61,19 @@ AEnemy::AEnemy() : HealthBarDisplayTime(4.f),
   HealthComponent->MaxHealth = 100.f;
   HealthComponent->bHealthRegenActive = false,
 
-  // Create the Agro Sphere
-      AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
+  // Create the Agro Sphere, only its radius is used so it is never registered, no collision or transform updates
+  AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
   AgroSphere->SetupAttachment(GetRootComponent());
+  AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  AgroSphere->SetGenerateOverlapEvents(false);
+  AgroSphere->bAutoRegister = false;
 
-  // Create the Combat Range Sphere
+  // Create the Combat Range Sphere, only its radius is used
   CombatRangeSphere = CreateDefaultSubobject<USphereComponent>(TEXT("CombatRangeSphere"));
   CombatRangeSphere->SetupAttachment(GetRootComponent());
-
-  // Create the left and right weapons collision boxes
-  LeftWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Left Weapon Box"));
-  LeftWeaponCollision->SetupAttachment(GetMesh(), FName("LeftWeaponBone"));
-  RightWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Right Weapon Box"));
-  RightWeaponCollision->SetupAttachment(GetMesh(), FName("RightWeaponBone"));
+  CombatRangeSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  CombatRangeSphere->SetGenerateOverlapEvents(false);
+  CombatRangeSphere->bAutoRegister = false;
 }
 
 // Called when the game starts or when spawned
@@ -65,34 +81,10 @@ void AEnemy::BeginPlay()
 {
   Super::BeginPlay();
 
-  AgroSphere->OnComponentBeginOverlap.AddDynamic(
-      this,
-      &AEnemy::AgroSphereOverlap);
-  CombatRangeSphere->OnComponentBeginOverlap.AddDynamic(
-      this,
-      &AEnemy::CombatRangeOverlap);
-  CombatRangeSphere->OnComponentEndOverlap.AddDynamic(
-      this,
-      &AEnemy::CombatRangeEndOverlap);
-
-  // Bind functions to overlap events for weapon boxes
-  LeftWeaponCollision->OnComponentBeginOverlap.AddDynamic(
-      this,
-      &AEnemy::OnWeaponOverlap);
-  RightWeaponCollision->OnComponentBeginOverlap.AddDynamic(
-      this,
-      &AEnemy::OnWeaponOverlap);
-  // Set collision presets for weapon boxes
-  LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-  LeftWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-  LeftWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-  LeftWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-  RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-  RightWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-  RightWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-  RightWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-
   GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+  // Bullets hit the mesh bodies, not the capsule
+  GetMesh()->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Block);
+  GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
   // Ignore camera from collision
   GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
   GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
@@ -112,16 +104,68 @@ void AEnemy::BeginPlay()
 
   if (EnemyController)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint1"), WorldPatrolPoint1);
-    EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint2"), WorldPatrolPoint2);
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), true);
+    FEnemyBlackboard &Blackboard = EnemyController->GetEnemyBlackboard();
+    Blackboard.SetPatrolPoint1(WorldPatrolPoint1);
+    Blackboard.SetPatrolPoint2(WorldPatrolPoint2);
+    // Attacks wait for a token, given once a player is in range
+    Blackboard.SetCanAttack(false);
 
     EnemyController->RunBehaviorTree(BehaviorTree);
   }
 
   HealthComponent->Health = HealthComponent->MaxHealth;
 
+  InitializeDamageZones();
+
+  // Shared by every enemy of the same type
+  if (auto FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>())
+  {
+    FXPool->Prewarm(ImpactParticles, 8);
+  }
+
+  // The server keeps a history of the hitboxes to check client shots
+  auto LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+  if (LagCompensation && HasAuthority())
+  {
+    LagCompensation->RegisterTarget(GetMesh());
+  }
+
   BaseMovementSpeed = GetCharacterMovement()->MaxWalkSpeed;
+
+  if (auto EnemyLOD = GetWorld()->GetSubsystem<UEnemyLODSubsystem>())
+  {
+    EnemyLOD->RegisterEnemy(this);
+  }
+
+  if (auto Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+  {
+    Perception->RegisterEnemy(this);
+  }
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (auto EnemyLOD = GetWorld()->GetSubsystem<UEnemyLODSubsystem>())
+  {
+    EnemyLOD->UnregisterEnemy(this);
+  }
+
+  if (auto Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+  {
+    Perception->UnregisterEnemy(this);
+  }
+
+  if (auto AttackTokens = GetWorld()->GetSubsystem<UAttackTokenSubsystem>())
+  {
+    AttackTokens->ReleaseToken(this);
+  }
+
+  if (auto LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
+  {
+    LagCompensation->UnregisterTarget(GetMesh());
+  }
+
+  Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::ShowHealthBar_Implementation()
@@ -147,13 +191,33 @@ void AEnemy::Die()
 
   SetActorEnableCollision(false);
 
+  if (auto LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
+  {
+    LagCompensation->UnregisterTarget(GetMesh());
+  }
+
+  if (auto EnemyLOD = GetWorld()->GetSubsystem<UEnemyLODSubsystem>())
+  {
+    EnemyLOD->UnregisterEnemy(this);
+  }
+
+  if (auto Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+  {
+    Perception->UnregisterEnemy(this);
+  }
+
+  if (auto AttackTokens = GetWorld()->GetSubsystem<UAttackTokenSubsystem>())
+  {
+    AttackTokens->ReleaseToken(this);
+  }
+
   if (EnemyController)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(
-        FName("Dead"),
-        true);
+    EnemyController->GetEnemyBlackboard().SetDead(true);
 
     EnemyController->StopMovement();
+    // Frees the crowd slot for living enemies
+    EnemyController->SetCrowdSimulationEnabled(false);
   }
 }
 
@@ -203,77 +267,69 @@ void AEnemy::DestroyHitNumber(UUserWidget *HitNumber, FVector Location)
   // HitNumber->RemoveFromParent();
 }
 
-void AEnemy::AgroSphereOverlap(
-    UPrimitiveComponent *OverlappedComponent,
-    AActor *OtherActor,
-    UPrimitiveComponent *OtherComp,
-    int32 OtherBodyIndex,
-    bool bFromSweep,
-    const FHitResult &SweepResult)
+void AEnemy::OnPlayerEnteredAgro(AShooterCharacter *Player)
 {
-  if (!OtherActor)
-    return;
-
-  auto Character = Cast<AShooterCharacter>(OtherActor);
-  if (Character)
+  // Set the value of Target Blackboard Key
+  if (EnemyController)
   {
-    // Set the value of Target Blackboard Key
-    if (EnemyController && EnemyController->GetBlackboardComponent())
-    {
-      EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("Target"), Character);
-    }
+    EnemyController->GetEnemyBlackboard().SetTarget(Player);
   }
 }
 
-void AEnemy::CombatRangeOverlap(
-    UPrimitiveComponent *OverlappedComponent,
-    AActor *OtherActor,
-    UPrimitiveComponent *OtherComp,
-    int32 OtherBodyIndex,
-    bool bFromSweep,
-    const FHitResult &SweepResult)
+void AEnemy::SetInAttackRange(bool bInRange, AShooterCharacter *Player)
 {
-  if (!OtherActor)
-    return;
-
-  auto ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-  if (!ShooterCharacter)
+  if (bInRange == bInAttackRange && Player == AttackRangeTarget.Get())
     return;
 
-  bInAttackRange = true;
+  bInAttackRange = bInRange;
+  AttackRangeTarget = Player;
   if (EnemyController)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(
-        TEXT("InAttackRange"),
-        true);
+    EnemyController->GetEnemyBlackboard().SetInAttackRange(bInRange);
+  }
+
+  if (auto AttackTokens = GetWorld()->GetSubsystem<UAttackTokenSubsystem>())
+  {
+    // Requesting a token for another target gives back the one of the previous target
+    if (bInRange)
+    {
+      AttackTokens->RequestToken(this, Player);
+    }
+    else
+    {
+      AttackTokens->ReleaseToken(this);
+    }
   }
 }
 
-void AEnemy::CombatRangeEndOverlap(
-    UPrimitiveComponent *OverlappedComponent,
-    AActor *OtherActor,
-    UPrimitiveComponent *OtherComp,
-    int32 OtherBodyIndex)
+void AEnemy::SetHasAttackToken(bool bHasToken)
 {
-  if (!OtherActor)
-    return;
-
-  auto ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-  if (!ShooterCharacter)
-    return;
+  bHasAttackToken = bHasToken;
+  UpdateCanAttackKey();
+}
 
-  bInAttackRange = false;
+void AEnemy::UpdateCanAttackKey()
+{
   if (EnemyController)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(
-        TEXT("InAttackRange"),
-        false);
+    EnemyController->GetEnemyBlackboard().SetCanAttack(bCanAttack && bHasAttackToken);
   }
 }
 
+float AEnemy::GetAgroRadius() const
+{
+  // The sphere isn't registered, its world scale is never computed
+  return AgroSphere->GetUnscaledSphereRadius() * (AgroSphere->GetRelativeScale3D() * GetActorScale3D()).GetMin();
+}
+
+float AEnemy::GetCombatRange() const
+{
+  return CombatRangeSphere->GetUnscaledSphereRadius() * (CombatRangeSphere->GetRelativeScale3D() * GetActorScale3D()).GetMin();
+}
+
 void AEnemy::AttackPlayer(FName MontageSection)
 {
-  if (!bCanAttack)
+  if (!bCanAttack || !bHasAttackToken)
     return;
 
   PlayMontage(AttackMontage, MontageSection);
@@ -284,10 +340,7 @@ void AEnemy::AttackPlayer(FName MontageSection)
       &AEnemy::ResetCanAttack,
       AttackWaitTime);
 
-  if (EnemyController)
-  {
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), false);
-  }
+  UpdateCanAttackKey();
 }
 
 FName AEnemy::GetAttackSectionName()
@@ -388,78 +441,80 @@ void AEnemy::DoDamage(AActor *Target, const FHitResult &SweepResult)
     return;
   }
 
-  UGameplayStatics::ApplyDamage(Character,
-                                BasicAttackDamage,
-                                EnemyController,
-                                this,
-                                UDamageType::StaticClass());
-
-  if (Character->IsDead())
+  // Applied at the end of the frame, OnTargetKilled is called if the hit kills
+  if (auto DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>())
   {
-    Taunt();
-    SetEnemyState(EEnemyState::EES_Taunting);
+    DamageQueue->QueueDamage(Character, BasicAttackDamage, EnemyController, this);
   }
 
-  if (Character->GetMeleeImpactSound())
+  if (auto EnemyAudio = GetWorld()->GetSubsystem<UEnemyAudioSubsystem>())
   {
-    UGameplayStatics::PlaySoundAtLocation(
-        this,
-        Character->GetMeleeImpactSound(),
-        Character->GetActorLocation());
+    EnemyAudio->PlayEnemySound(Character->GetMeleeImpactSound(), Character->GetActorLocation(), SoundConcurrency);
   }
 
   if (Character->GetBloodParticles())
   {
-    const int32 BoneIndex = Character->GetMesh()->GetBoneIndex(SweepResult.BoneName);
-
-    UGameplayStatics::SpawnEmitterAtLocation(
-        GetWorld(),
-        Character->GetBloodParticles(),
-        SweepResult.ImpactPoint);
+    UImpactFXSubsystem::SpawnImpact(
+        this,
+        EImpactType::EIT_Blood,
+        SweepResult.ImpactPoint,
+        SweepResult.ImpactNormal,
+        SurfaceType_Default,
+        1.f,
+        Character->GetBloodParticles());
   }
 
   Character->Stagger();
 }
 
-void AEnemy::OnWeaponOverlap(
-    UPrimitiveComponent *OverlappedComponent,
-    AActor *OtherActor,
-    UPrimitiveComponent *OtherComp,
-    int32 OtherBodyIndex,
-    bool bFromSweep,
-    const FHitResult &SweepResult)
-{
-  DoDamage(OtherActor, SweepResult);
-  // Character->GetMesh()->GetBoneLocation()
-}
-
 void AEnemy::ActivateLeftWeapon()
 {
-  LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+  if (auto MeleeSweep = GetWorld()->GetSubsystem<UMeleeSweepSubsystem>())
+  {
+    MeleeSweep->BeginSwing(this, LeftWeaponBone, MeleeWeaponRadius);
+  }
 }
 
 void AEnemy::DeactivateLeftWeapon()
 {
-  LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  if (auto MeleeSweep = GetWorld()->GetSubsystem<UMeleeSweepSubsystem>())
+  {
+    MeleeSweep->EndSwing(this, LeftWeaponBone);
+  }
 }
 
 void AEnemy::ActivateRightWeapon()
 {
-  RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+  if (auto MeleeSweep = GetWorld()->GetSubsystem<UMeleeSweepSubsystem>())
+  {
+    MeleeSweep->BeginSwing(this, RightWeaponBone, MeleeWeaponRadius);
+  }
 }
 
 void AEnemy::DeactivateRightWeapon()
 {
-  RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  if (auto MeleeSweep = GetWorld()->GetSubsystem<UMeleeSweepSubsystem>())
+  {
+    MeleeSweep->EndSwing(this, RightWeaponBone);
+  }
 }
 
 void AEnemy::ResetCanAttack()
 {
   bCanAttack = true;
-  if (EnemyController)
+
+  // Give the waiting enemies their turn, then queue again
+  auto AttackTokens = GetWorld()->GetSubsystem<UAttackTokenSubsystem>();
+  if (AttackTokens && bHasAttackToken)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), true);
+    AttackTokens->ReleaseToken(this);
+    if (bInAttackRange && AttackRangeTarget.IsValid())
+    {
+      AttackTokens->RequestToken(this, AttackRangeTarget.Get());
+    }
   }
+
+  UpdateCanAttackKey();
 }
 
 void AEnemy::FinishDeath()
@@ -481,12 +536,74 @@ bool AEnemy::TriggerChance(float Chance)
   return false;
 }
 
+void AEnemy::InitializeDamageZones()
+{
+  if (DamageZones.Num() == 0 && !WeakspotBone.IsEmpty())
+  {
+    // Enemies set up with a single weakspot bone
+    FDamageZone WeakspotZone;
+    WeakspotZone.ZoneName = FName("Weakspot");
+    WeakspotZone.Bones.Add(FName(*WeakspotBone));
+    WeakspotZone.bWeakspot = true;
+    DamageZones.Add(WeakspotZone);
+  }
+
+  const UPhysicsAsset *PhysicsAsset = GetMesh()->GetPhysicsAsset();
+  if (!PhysicsAsset)
+    return;
+
+  // Mesh bodies are created in the same order as the physics asset body setups
+  BodyDamageZones.Init(INDEX_NONE, PhysicsAsset->SkeletalBodySetups.Num());
+
+  for (int32 ZoneIndex = 0; ZoneIndex < DamageZones.Num(); ZoneIndex++)
+  {
+    for (const FName &Bone : DamageZones[ZoneIndex].Bones)
+    {
+      const int32 BodyIndex = PhysicsAsset->FindBodyIndex(Bone);
+      if (BodyDamageZones.IsValidIndex(BodyIndex))
+      {
+        BodyDamageZones[BodyIndex] = ZoneIndex;
+      }
+    }
+  }
+}
+
+const FDamageZone *AEnemy::GetDamageZone(const FHitResult &HitResult) const
+{
+  if (HitResult.GetComponent() != GetMesh())
+    return nullptr;
+
+  // Item holds the physics body index for skeletal mesh hits
+  const int32 BodyIndex = HitResult.Item;
+  if (!BodyDamageZones.IsValidIndex(BodyIndex) || BodyDamageZones[BodyIndex] == INDEX_NONE)
+    return nullptr;
+
+  return &DamageZones[BodyDamageZones[BodyIndex]];
+}
+
 // Called every frame
 void AEnemy::Tick(float DeltaTime)
 {
   Super::Tick(DeltaTime);
 }
 
+void AEnemy::SetAILODTier(EEnemyLOD Tier)
+{
+  AILODTier = Tier;
+  const FEnemyLODSettings &Settings = UEnemyLODSubsystem::GetTierSettings(Tier);
+
+  if (EnemyController)
+  {
+    EnemyController->SetBehaviorTreeTickInterval(Settings.BehaviorTreeTickInterval);
+    EnemyController->SetCrowdAvoidanceQuality(Settings.CrowdAvoidanceQuality);
+  }
+
+  GetCharacterMovement()->MaxSimulationIterations = Settings.MaxSimulationIterations;
+
+  GetMesh()->SetComponentTickInterval(Settings.AnimationTickInterval);
+  GetMesh()->VisibilityBasedAnimTickOption = Settings.AnimationTickOption;
+}
+
 // Called to bind functionality to input
 void AEnemy::SetupPlayerInputComponent(UInputComponent *PlayerInputComponent)
 {
@@ -495,24 +612,21 @@ void AEnemy::SetupPlayerInputComponent(UInputComponent *PlayerInputComponent)
 
 void AEnemy::BulletHit_Implementation(FHitResult HitResult, AActor *Shooter, AController *InstigatorController)
 {
-  if (ImpactSound)
-  {
-    UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
-  }
+  // Impact effects only, nothing to show on a dedicated server
+  if (GetWorld()->IsNetMode(NM_DedicatedServer))
+    return;
 
-  if (ImpactParticles)
+  if (auto ImpactSignificance = GetWorld()->GetSubsystem<UImpactSignificanceSubsystem>())
   {
-    UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, HitResult.Location, FRotator(0.f), true);
+    ImpactSignificance->QueueImpact(this, HitResult, ImpactSound, ImpactParticles, SoundConcurrency);
   }
 }
 
 float AEnemy::TakeDamage(float DamageAmount, struct FDamageEvent const &DamageEvent, AController *EventInstigator, AActor *DamageCauser)
 {
-  if (EnemyController)
+  if (EnemyController && EventInstigator)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsObject(
-        FName("Target"),
-        EventInstigator->GetPawn());
+    EnemyController->GetEnemyBlackboard().SetTarget(EventInstigator->GetPawn());
   }
 
   HealthComponent->TakeDamage(DamageAmount);
@@ -561,13 +675,19 @@ void AEnemy::TakeBalanceDamage(float Amount)
   }
 }
 
+void AEnemy::OnTargetKilled()
+{
+  Taunt();
+  SetEnemyState(EEnemyState::EES_Taunting);
+}
+
 void AEnemy::SetEnemyState(EEnemyState State)
 {
   EnemyState = State;
   uint8 EnumByte = (uint8)State;
-  if (EnemyController && EnemyController->GetBlackboardComponent())
+  if (EnemyController)
   {
-    EnemyController->GetBlackboardComponent()->SetValueAsEnum(FName("EnemyState"), EnumByte);
+    EnemyController->GetEnemyBlackboard().SetEnemyState(EnumByte);
   }
 }
 
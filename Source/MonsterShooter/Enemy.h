@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "BulletHitInterface.h"
+#include "EnemyLOD.h"
+#include "EnemyType.h"
 #include "Enemy.generated.h"
 
 UENUM(BlueprintType)
@@ -23,15 +25,26 @@ enum class EEnemyState : uint8
   EES_MAX UMETA(DisplayName = "DefaultMAX")
 };
 
-UENUM(BlueprintType)
-enum class EEnemyType : uint8
+USTRUCT(BlueprintType)
+struct FDamageZone
 {
-  EET_Grux UMETA(DisplayName = "Grux"),
-  EET_Warchief UMETA(DisplayName = "Warchief"),
-  EET_Gruxling UMETA(DisplayName = "Gruxling"),
-  EET_Qilin UMETA(DisplayName = "Qilin"),
+  GENERATED_BODY()
+
+  /** Display name of the zone (Head, LeftArm, BackPlates...) */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FName ZoneName;
+
+  /** Bones whose physics bodies belong to the zone */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  TArray<FName> Bones;
+
+  /** Multiplier applied to the weapon damage for hits in the zone */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float DamageMultiplier = 1.f;
 
-  EET_MAX UMETA(DisplayName = "DefaultMAX")
+  /** Hits in the zone use the weapon weakspot damage */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bWeakspot = false;
 };
 
 UCLASS()
@@ -47,6 +60,8 @@ protected:
   // Called when the game starts or when spawned
   virtual void BeginPlay() override;
 
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
   UFUNCTION(BlueprintNativeEvent)
   void ShowHealthBar();
   void ShowHealthBar_Implementation();
@@ -68,32 +83,6 @@ protected:
   UFUNCTION(BlueprintCallable)
   void DestroyHitNumber(UUserWidget *HitNumber, FVector Location);
 
-  /** Called when something overlaps with the agro sphere */
-  UFUNCTION()
-  void AgroSphereOverlap(
-      UPrimitiveComponent *OverlappedComponent,
-      AActor *OtherActor,
-      UPrimitiveComponent *OtherComp,
-      int32 OtherBodyIndex,
-      bool bFromSweep,
-      const FHitResult &SweepResult);
-
-  UFUNCTION()
-  void CombatRangeOverlap(
-      UPrimitiveComponent *OverlappedComponent,
-      AActor *OtherActor,
-      UPrimitiveComponent *OtherComp,
-      int32 OtherBodyIndex,
-      bool bFromSweep,
-      const FHitResult &SweepResult);
-
-  UFUNCTION()
-  void CombatRangeEndOverlap(
-      UPrimitiveComponent *OverlappedComponent,
-      AActor *OtherActor,
-      UPrimitiveComponent *OtherComp,
-      int32 OtherBodyIndex);
-
   UFUNCTION(BlueprintCallable)
   void AttackPlayer(FName MontageSection);
 
@@ -115,16 +104,7 @@ protected:
   UFUNCTION(BlueprintCallable)
   void Dodge(float Chance = 0.1f);
 
-  UFUNCTION()
-  void OnWeaponOverlap(
-      UPrimitiveComponent *OverlappedComponent,
-      AActor *OtherActor,
-      UPrimitiveComponent *OtherComp,
-      int32 OtherBodyIndex,
-      bool bFromSweep,
-      const FHitResult &SweepResult);
-
-  // Activate / deactivate weapon collision
+  // Start / stop sweeping the weapon bones, called by the attack montage notifies
   UFUNCTION(BlueprintCallable)
   void ActivateLeftWeapon();
   UFUNCTION(BlueprintCallable)
@@ -134,15 +114,19 @@ protected:
   UFUNCTION(BlueprintCallable)
   void DeactivateRightWeapon();
 
-  void DoDamage(AActor *Target, const FHitResult &SweepResult);
-
   void ResetCanAttack();
 
+  /** Writes CanAttack, true when off cooldown and holding an attack token */
+  void UpdateCanAttackKey();
+
   UFUNCTION(BlueprintCallable)
   void FinishDeath();
 
   bool TriggerChance(float Chance);
 
+  /** Maps every physics body of the mesh to its damage zone */
+  void InitializeDamageZones();
+
 private:
   /** Particles to spawn when hit by bullets */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
@@ -152,10 +136,21 @@ private:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
   class USoundCue *ImpactSound;
 
-  /** Name of the bone that represents the weakspot */
+  /** Concurrency group of the impact and melee sounds of this enemy type */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  class USoundConcurrency *SoundConcurrency;
+
+  /** Name of the bone that represents the weakspot, only used when DamageZones is empty */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
   FString WeakspotBone;
 
+  /** Damage zones of the enemy skeleton, hits outside every zone take the base weapon damage */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  TArray<FDamageZone> DamageZones;
+
+  /** Index in DamageZones for each physics body of the mesh, INDEX_NONE when outside every zone */
+  TArray<int32> BodyDamageZones;
+
   /** How much time the health bar remains displayed when the enemy is hit */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
   float HealthBarDisplayTime;
@@ -201,7 +196,7 @@ private:
 
   class AEnemyController *EnemyController;
 
-  /** Overlap sphere for when the enemy becomes hostile */
+  /** Radius in which the enemy becomes hostile, tested by the perception subsystem. Never registered, only its radius is read */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
   class USphereComponent *AgroSphere;
 
@@ -221,7 +216,7 @@ private:
   UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
   bool bInAttackRange;
 
-  /** Sphere for attack range */
+  /** Attack range, tested by the perception subsystem. Never registered, only its radius is read */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
   USphereComponent *CombatRangeSphere;
 
@@ -236,13 +231,17 @@ private:
   FName AttackRFast;
   FName RushAttackSection;
 
-  /** Collision volume for the left weapon */
-  UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
-  class UBoxComponent *LeftWeaponCollision;
+  /** Bone swept by left weapon attacks */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  FName LeftWeaponBone;
 
-  /** Collision volume for the right weapon */
-  UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
-  UBoxComponent *RightWeaponCollision;
+  /** Bone swept by right weapon attacks */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  FName RightWeaponBone;
+
+  /** Radius of the sphere swept along the weapon bones */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  float MeleeWeaponRadius;
 
   /** Damage dealt by basic attacks */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
@@ -252,6 +251,13 @@ private:
   UPROPERTY(VisibleAnywhere, Category = "Combat", meta = (AllowPrivateAccess = "true"))
   bool bCanAttack;
 
+  /** If the enemy holds an attack token for its target, only token holders attack */
+  UPROPERTY(VisibleAnywhere, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+  bool bHasAttackToken;
+
+  /** Player in attack range, the target of the attack token */
+  TWeakObjectPtr<AActor> AttackRangeTarget;
+
   FTimerHandle AttackWaitTimer;
 
   /** Wait time between attacks */
@@ -291,6 +297,10 @@ private:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Type", meta = (AllowPrivateAccess = "true"))
   EEnemyType EnemyType;
 
+  /** AI level of detail, set by the enemy LOD subsystem */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI", meta = (AllowPrivateAccess = "true"))
+  EEnemyLOD AILODTier;
+
 public:
   // Called every frame
   virtual void Tick(float DeltaTime) override;
@@ -304,14 +314,39 @@ public:
 
   void TakeBalanceDamage(float Amount);
 
+  /** Called when damage dealt by this enemy kills its target */
+  void OnTargetKilled();
+
+  /** Damages Target hit by a melee swing */
+  void DoDamage(AActor *Target, const FHitResult &SweepResult);
+
   UFUNCTION(BlueprintCallable)
   void SetEnemyState(EEnemyState State);
 
   UFUNCTION(BlueprintImplementableEvent)
   void ShowHitNumber(int32 Damage, FVector HitLocation, bool bWeakspot);
 
-  FORCEINLINE FString GetWeakspotBone() const { return WeakspotBone; }
+  /** Damage zone of a hit on the mesh, looked up by physics body index. Null when outside every zone */
+  const FDamageZone *GetDamageZone(const FHitResult &HitResult) const;
+
+  /** Applies the update rates of an AI LOD tier to the behavior tree, movement and animation */
+  void SetAILODTier(EEnemyLOD Tier);
+
+  /** Called by the perception subsystem when a player comes within the agro radius */
+  void OnPlayerEnteredAgro(class AShooterCharacter *Player);
+
+  /** Called by the perception subsystem when a player enters or leaves the combat range, or another player becomes the closest in it */
+  void SetInAttackRange(bool bInRange, AShooterCharacter *Player);
+
+  /** Called by the attack token subsystem when the enemy gets or loses its token */
+  void SetHasAttackToken(bool bHasToken);
+
+  float GetAgroRadius() const;
+  float GetCombatRange() const;
+
   FORCEINLINE UBehaviorTree *GetBehaviorTree() const { return BehaviorTree; }
+  FORCEINLINE EEnemyLOD GetAILODTier() const { return AILODTier; }
+  FORCEINLINE EEnemyType GetEnemyType() const { return EnemyType; }
 
   FORCEINLINE void SetBalance(float Amount) { Balance = Amount; }
   float GetHealth() const;
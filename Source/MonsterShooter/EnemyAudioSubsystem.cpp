@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyAudioSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "AudioDevice.h"
+
+static TAutoConsoleVariable<float> CVarEnemySoundDedupRadius(
+    TEXT("MonsterShooter.Audio.EnemySoundDedupRadius"),
+    300.f,
+    TEXT("Same enemy sound started again within this distance in the same frame is dropped. 0 disables deduplication."),
+    ECVF_Default);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice EnemyAudioStatsCommand(
+    TEXT("MonsterShooter.Audio.EnemyStats"),
+    TEXT("Prints how many enemy sound voices were started and how many were avoided."),
+    FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+        [](const TArray<FString> &Args, UWorld *World, FOutputDevice &Ar)
+        {
+          if (auto EnemyAudio = World ? World->GetSubsystem<UEnemyAudioSubsystem>() : nullptr)
+          {
+            EnemyAudio->DumpStats(Ar);
+          }
+        }));
+
+bool UEnemyAudioSubsystem::PlayEnemySound(USoundBase *Sound, const FVector &Location, USoundConcurrency *Concurrency)
+{
+  if (!Sound)
+    return false;
+
+  RefreshFrame();
+
+  const float DedupRadius = CVarEnemySoundDedupRadius.GetValueOnGameThread();
+  if (DedupRadius > 0.f)
+  {
+    const float DedupRadiusSquared = DedupRadius * DedupRadius;
+    for (const FPlayedEnemySound &Played : PlayedThisFrame)
+    {
+      if (Played.Sound.Get() == Sound && FVector::DistSquared(Played.Location, Location) <= DedupRadiusSquared)
+      {
+        DedupedVoices++;
+        return false;
+      }
+    }
+  }
+
+  // Out of hearing range. Sounds that can be virtualized still start, so loops and long cues
+  // resume when the listener comes back. The others would be dropped by the mixer anyway
+  FAudioDeviceHandle AudioDevice = GetWorld()->GetAudioDevice();
+  if (AudioDevice &&
+      Sound->VirtualizationMode == EVirtualizationMode::Disabled &&
+      !AudioDevice->LocationIsAudible(Location, Sound->GetMaxDistance()))
+  {
+    InaudibleVoices++;
+    return false;
+  }
+
+  UGameplayStatics::PlaySoundAtLocation(
+      this,
+      Sound,
+      Location,
+      FRotator::ZeroRotator,
+      1.f,
+      1.f,
+      0.f,
+      nullptr,
+      Concurrency);
+
+  PlayedThisFrame.Add({Sound, Location});
+  StartedVoices++;
+  return true;
+}
+
+void UEnemyAudioSubsystem::DumpStats(FOutputDevice &Ar) const
+{
+  Ar.Logf(
+      TEXT("Enemy sounds: %d started, %d avoided (%d duplicates, %d inaudible)"),
+      StartedVoices,
+      DedupedVoices + InaudibleVoices,
+      DedupedVoices,
+      InaudibleVoices);
+}
+
+bool UEnemyAudioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyAudioSubsystem::RefreshFrame()
+{
+  if (SoundFrame != GFrameCounter)
+  {
+    SoundFrame = GFrameCounter;
+    PlayedThisFrame.Reset();
+  }
+}
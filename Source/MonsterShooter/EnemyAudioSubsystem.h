@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyAudioSubsystem.generated.h"
+
+class USoundBase;
+class USoundConcurrency;
+
+/** Sound started this frame, used to drop copies played next to it */
+struct FPlayedEnemySound
+{
+  TWeakObjectPtr<USoundBase> Sound;
+  FVector Location;
+};
+
+/**
+ * Single entry point for the impact and melee sounds of enemies. Before a voice is started, copies of the same cue
+ * already played this frame near the same spot are dropped, and sounds out of the listener's hearing range are
+ * never started unless their virtualization mode keeps them alive. Started sounds use the concurrency group of their enemy type. Counts the voices avoided
+ */
+UCLASS()
+class MONSTERSHOOTER_API UEnemyAudioSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  /** Plays Sound at Location unless it is a duplicate or inaudible, returns true if a voice was started */
+  bool PlayEnemySound(USoundBase *Sound, const FVector &Location, USoundConcurrency *Concurrency);
+
+  /** Prints the voice counters to Ar */
+  void DumpStats(FOutputDevice &Ar) const;
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Forgets the sounds of the previous frame */
+  void RefreshFrame();
+
+  /** Frame PlayedThisFrame belongs to */
+  uint64 SoundFrame = 0;
+
+  TArray<FPlayedEnemySound> PlayedThisFrame;
+
+  // Voice counters since the world started
+  int32 StartedVoices = 0;
+  int32 DedupedVoices = 0;
+  int32 InaudibleVoices = 0;
+};
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyBehaviorTreeComponent.h"
+
+void UEnemyBehaviorTreeComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+  // Messages, finished latent tasks and aborts are never held back, only the ticks of tasks and services are
+  const bool bHasPendingWork = bRequestedFlowUpdate || MessagesToProcess.Num() > 0;
+  SkippedDeltaTime += DeltaTime;
+  if (MinTickInterval > 0.f && !bHasPendingWork && SkippedDeltaTime < MinTickInterval)
+    return;
+
+  // Ticked tasks and services still see all the time that passed
+  DeltaTime = SkippedDeltaTime;
+  SkippedDeltaTime = 0.f;
+
+  Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void UEnemyBehaviorTreeComponent::SetMinTickInterval(float Interval)
+{
+  MinTickInterval = FMath::Max(Interval, 0.f);
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "EnemyBehaviorTreeComponent.generated.h"
+
+/**
+ * Behavior tree component that can be throttled by the AI LOD. The behavior tree schedules its own tick
+ * interval, overriding any set on the component, so ticks are instead skipped here until the minimum
+ * interval has passed and the tree is then ticked with the time accumulated since its last tick.
+ * Ticks with a requested execution update or AI messages waiting always go through, so the tree still
+ * reacts to finished latent tasks, aborts and messages on the next frame
+ */
+UCLASS()
+class MONSTERSHOOTER_API UEnemyBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+  GENERATED_BODY()
+
+public:
+  virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+  /** Seconds the tree waits at least between two ticks, 0 to tick whenever it asks to */
+  void SetMinTickInterval(float Interval);
+
+private:
+  float MinTickInterval = 0.f;
+
+  /** Time of the ticks skipped since the tree last ticked */
+  float SkippedDeltaTime = 0.f;
+};
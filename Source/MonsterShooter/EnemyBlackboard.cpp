@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyBlackboard.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "MonsterShooter.h"
+
+namespace
+{
+  FBlackboard::FKey ResolveKey(const UBlackboardComponent *Blackboard, const TCHAR *KeyName, const UClass *KeyType, bool bReport)
+  {
+    const FBlackboard::FKey Key = Blackboard->GetKeyID(FName(KeyName));
+    if (Key == FBlackboard::InvalidKey)
+    {
+      UE_CLOG(bReport, LogMonsterShooter, Warning, TEXT("Blackboard %s has no key %s"), *GetNameSafe(Blackboard->GetBlackboardAsset()), KeyName);
+      return FBlackboard::InvalidKey;
+    }
+
+    if (Blackboard->GetKeyType(Key) != KeyType)
+    {
+      UE_CLOG(bReport, LogMonsterShooter, Warning, TEXT("Blackboard %s key %s is not a %s"), *GetNameSafe(Blackboard->GetBlackboardAsset()), KeyName, *GetNameSafe(KeyType));
+      return FBlackboard::InvalidKey;
+    }
+
+    return Key;
+  }
+}
+
+void FEnemyBlackboard::Initialize(UBlackboardComponent *InBlackboard)
+{
+  Blackboard = InBlackboard;
+  if (!InBlackboard || !InBlackboard->GetBlackboardAsset())
+    return;
+
+  // Every enemy resolves the same asset, its problems are only reported the first time
+  static TSet<TWeakObjectPtr<const UBlackboardData>> ReportedAssets;
+  bool bAlreadyReported = false;
+  ReportedAssets.Add(InBlackboard->GetBlackboardAsset(), &bAlreadyReported);
+  const bool bReport = !bAlreadyReported;
+
+#define ENEMY_BLACKBOARD_RESOLVE_KEY(KeyName, KeyType) \
+  KeyName##Key = ResolveKey(InBlackboard, TEXT(#KeyName), UBlackboardKeyType_##KeyType::StaticClass(), bReport);
+  ENEMY_BLACKBOARD_KEYS(ENEMY_BLACKBOARD_RESOLVE_KEY)
+#undef ENEMY_BLACKBOARD_RESOLVE_KEY
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Enum.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+
+// Keys of the enemy blackboard asset, X(KeyName, KeyType) with KeyType the UBlackboardKeyType_ suffix
+#define ENEMY_BLACKBOARD_KEYS(X) \
+  X(Target, Object)              \
+  X(CanAttack, Bool)             \
+  X(InAttackRange, Bool)         \
+  X(EnemyState, Enum)            \
+  X(CharacterIsDead, Bool)       \
+  X(Dead, Bool)                  \
+  X(PatrolPoint1, Vector)        \
+  X(PatrolPoint2, Vector)
+
+/**
+ * Typed access to the enemy blackboard. Every key of ENEMY_BLACKBOARD_KEYS gets a Set and Get function
+ * working on a key ID resolved once in Initialize, so writes never look keys up by name
+ */
+struct FEnemyBlackboard
+{
+  /** Resolves the key IDs of Blackboard, reporting keys missing from its asset or of another type once per asset */
+  void Initialize(UBlackboardComponent *InBlackboard);
+
+#define ENEMY_BLACKBOARD_ACCESSORS(KeyName, KeyType)                                          \
+  FORCEINLINE void Set##KeyName(UBlackboardKeyType_##KeyType::FDataType Value)               \
+  {                                                                                           \
+    SetValue<UBlackboardKeyType_##KeyType>(KeyName##Key, Value);                              \
+  }                                                                                           \
+  FORCEINLINE UBlackboardKeyType_##KeyType::FDataType Get##KeyName() const                   \
+  {                                                                                           \
+    return GetValue<UBlackboardKeyType_##KeyType>(KeyName##Key);                              \
+  }
+  ENEMY_BLACKBOARD_KEYS(ENEMY_BLACKBOARD_ACCESSORS)
+#undef ENEMY_BLACKBOARD_ACCESSORS
+
+private:
+  /** The component itself skips unchanged values, observers are only notified of changes */
+  template <typename TKeyType>
+  void SetValue(FBlackboard::FKey Key, typename TKeyType::FDataType Value)
+  {
+    UBlackboardComponent *BlackboardComponent = Blackboard.Get();
+    if (!BlackboardComponent || Key == FBlackboard::InvalidKey)
+      return;
+
+    BlackboardComponent->SetValue<TKeyType>(Key, Value);
+  }
+
+  template <typename TKeyType>
+  typename TKeyType::FDataType GetValue(FBlackboard::FKey Key) const
+  {
+    const UBlackboardComponent *BlackboardComponent = Blackboard.Get();
+    if (!BlackboardComponent || Key == FBlackboard::InvalidKey)
+      return TKeyType::InvalidValue;
+
+    return BlackboardComponent->GetValue<TKeyType>(Key);
+  }
+
+  TWeakObjectPtr<UBlackboardComponent> Blackboard;
+
+#define ENEMY_BLACKBOARD_KEY_ID(KeyName, KeyType) FBlackboard::FKey KeyName##Key = FBlackboard::InvalidKey;
+  ENEMY_BLACKBOARD_KEYS(ENEMY_BLACKBOARD_KEY_ID)
+#undef ENEMY_BLACKBOARD_KEY_ID
+};
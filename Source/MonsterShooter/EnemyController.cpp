@@ -2,17 +2,22 @@
 
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "EnemyBehaviorTreeComponent.h"
 #include "BehaviorTree/BehaviorTree.h"
+#include "Navigation/CrowdFollowingComponent.h"
 #include "Enemy.h"
 
-AEnemyController::AEnemyController()
+AEnemyController::AEnemyController(const FObjectInitializer &ObjectInitializer)
+    : Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent"))),
+      bUseCrowdAvoidance(true)
 {
   BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
   check(BlackboardComponent);
 
-  BehaviorTreeComponent = CreateDefaultSubobject<UBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
+  BehaviorTreeComponent = CreateDefaultSubobject<UEnemyBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
   check(BehaviorTreeComponent);
+  // RunBehaviorTree reuses the brain component instead of creating its own
+  BrainComponent = BehaviorTreeComponent;
 }
 
 void AEnemyController::OnPossess(APawn *InPawn)
@@ -29,5 +34,34 @@ void AEnemyController::OnPossess(APawn *InPawn)
   if (Enemy->GetBehaviorTree())
   {
     BlackboardComponent->InitializeBlackboard(*(Enemy->GetBehaviorTree()->BlackboardAsset));
+    EnemyBlackboard.Initialize(BlackboardComponent);
   }
+
+  SetCrowdSimulationEnabled(bUseCrowdAvoidance);
+}
+
+void AEnemyController::SetCrowdSimulationEnabled(bool bEnabled)
+{
+  if (UCrowdFollowingComponent *CrowdFollowing = GetCrowdFollowingComponent())
+  {
+    CrowdFollowing->SetCrowdSimulationState(bEnabled ? ECrowdSimulationState::Enabled : ECrowdSimulationState::Disabled);
+  }
+}
+
+void AEnemyController::SetCrowdAvoidanceQuality(ECrowdAvoidanceQuality::Type Quality)
+{
+  if (UCrowdFollowingComponent *CrowdFollowing = GetCrowdFollowingComponent())
+  {
+    CrowdFollowing->SetCrowdAvoidanceQuality(Quality);
+  }
+}
+
+void AEnemyController::SetBehaviorTreeTickInterval(float Interval)
+{
+  BehaviorTreeComponent->SetMinTickInterval(Interval);
+}
+
+UCrowdFollowingComponent *AEnemyController::GetCrowdFollowingComponent() const
+{
+  return Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
 }
@@ -4,19 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "EnemyBlackboard.h"
+#include "Navigation/CrowdManager.h"
 #include "EnemyController.generated.h"
 
 /**
- *
+ * Controller of every enemy. Paths are followed by a crowd following component, so packs steer around
+ * each other with detour crowd avoidance instead of pushing through capsule collisions.
+ * Enemies past the crowd's MaxAgents fall back to regular path following
  */
 UCLASS()
 class MONSTERSHOOTER_API AEnemyController : public AAIController
 {
   GENERATED_BODY()
 public:
-  AEnemyController();
+  AEnemyController(const FObjectInitializer &ObjectInitializer);
   virtual void OnPossess(APawn *InPawn) override;
 
+  /** Registers or removes the pawn from the crowd simulation, only while not following a path */
+  void SetCrowdSimulationEnabled(bool bEnabled);
+
+  /** Quality of the avoidance against other crowd agents, lower is cheaper */
+  void SetCrowdAvoidanceQuality(ECrowdAvoidanceQuality::Type Quality);
+
+  /** Seconds the behavior tree waits at least between two ticks, 0 for no limit */
+  void SetBehaviorTreeTickInterval(float Interval);
+
 private:
   /** Blackboard component for this enemy */
   UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
@@ -24,8 +37,17 @@ private:
 
   /** Behavior tree component for this enemy */
   UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
-  class UBehaviorTreeComponent *BehaviorTreeComponent;
+  class UEnemyBehaviorTreeComponent *BehaviorTreeComponent;
+
+  /** Typed keys of BlackboardComponent, resolved when the behavior tree blackboard is initialized */
+  FEnemyBlackboard EnemyBlackboard;
+
+  /** If the pawn joins the crowd simulation when possessed, regular path following otherwise */
+  UPROPERTY(EditDefaultsOnly, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
+  bool bUseCrowdAvoidance;
 
 public:
   FORCEINLINE UBlackboardComponent *GetBlackboardComponent() const { return BlackboardComponent; }
+  FORCEINLINE FEnemyBlackboard &GetEnemyBlackboard() { return EnemyBlackboard; }
+  class UCrowdFollowingComponent *GetCrowdFollowingComponent() const;
 };
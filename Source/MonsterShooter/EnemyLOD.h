@@ -0,0 +1,11 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EEnemyLOD : uint8
+{
+  EEL_Full UMETA(DisplayName = "Full"),
+  EEL_Reduced UMETA(DisplayName = "Reduced"),
+  EEL_Minimal UMETA(DisplayName = "Minimal"),
+
+  EEL_MAX UMETA(DisplayName = "DefaultMAX")
+};
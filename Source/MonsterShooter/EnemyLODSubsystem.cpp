@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyLODSubsystem.h"
+#include "Enemy.h"
+
+static TAutoConsoleVariable<float> CVarEnemyLODInterval(
+    TEXT("MonsterShooter.AI.LOD.EvaluationInterval"),
+    0.25f,
+    TEXT("Seconds to evaluate the AI LOD tier of every enemy once, the evaluations are spread over the frames."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyLODReducedDistance(
+    TEXT("MonsterShooter.AI.LOD.ReducedDistance"),
+    2500.f,
+    TEXT("Distance to the closest player past which enemies drop to the reduced AI LOD tier."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyLODMinimalDistance(
+    TEXT("MonsterShooter.AI.LOD.MinimalDistance"),
+    6000.f,
+    TEXT("Distance to the closest player past which enemies drop to the minimal AI LOD tier."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyLODHysteresis(
+    TEXT("MonsterShooter.AI.LOD.Hysteresis"),
+    300.f,
+    TEXT("Distance an enemy must come back inside a tier boundary before it moves up a tier."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEnemyLODNearDistance(
+    TEXT("MonsterShooter.AI.LOD.NearDistance"),
+    1200.f,
+    TEXT("Enemies closer than this to a player stay in the full tier even when off screen."),
+    ECVF_Default);
+
+void UEnemyLODSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  // Forget destroyed enemies
+  Enemies.RemoveAllSwap([](const TWeakObjectPtr<AEnemy> &Enemy)
+                        { return !Enemy.IsValid(); },
+                        false);
+  if (Enemies.Num() == 0)
+    return;
+
+  TArray<FVector> PlayerLocations;
+  for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+  {
+    const APlayerController *PlayerController = It->Get();
+    if (PlayerController && PlayerController->GetPawn())
+    {
+      PlayerLocations.Add(PlayerController->GetPawn()->GetActorLocation());
+    }
+  }
+  if (PlayerLocations.Num() == 0)
+    return;
+
+  // Every enemy is evaluated once per interval, a share of them each frame
+  const float Interval = FMath::Max(CVarEnemyLODInterval.GetValueOnGameThread(), KINDA_SMALL_NUMBER);
+  EvaluationCarry += Enemies.Num() * FMath::Min(DeltaTime / Interval, 1.f);
+  const int32 NumToEvaluate = FMath::Min(FMath::FloorToInt32(EvaluationCarry), Enemies.Num());
+  EvaluationCarry -= NumToEvaluate;
+
+  for (int32 i = 0; i < NumToEvaluate; i++)
+  {
+    NextEnemy = NextEnemy % Enemies.Num();
+    AEnemy *Enemy = Enemies[NextEnemy++].Get();
+
+    const EEnemyLOD CurrentTier = Enemy->GetAILODTier();
+    const EEnemyLOD NewTier = EvaluateTier(Enemy, CurrentTier, PlayerLocations);
+    if (NewTier != CurrentTier)
+    {
+      Enemy->SetAILODTier(NewTier);
+    }
+  }
+}
+
+TStatId UEnemyLODSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyLODSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyLODSubsystem::RegisterEnemy(AEnemy *Enemy)
+{
+  Enemies.AddUnique(Enemy);
+  Enemy->SetAILODTier(EEnemyLOD::EEL_Full);
+}
+
+void UEnemyLODSubsystem::UnregisterEnemy(AEnemy *Enemy)
+{
+  Enemies.RemoveSwap(Enemy, false);
+}
+
+const FEnemyLODSettings &UEnemyLODSubsystem::GetTierSettings(EEnemyLOD Tier)
+{
+  static const FEnemyLODSettings TierSettings[] = {
+      // Full
+      {0.f, 8, 1, 0.f, EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones, ECrowdAvoidanceQuality::High},
+      // Reduced
+      {0.2f, 4, 3, 0.f, EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered, ECrowdAvoidanceQuality::Medium},
+      // Minimal
+      {0.5f, 2, 10, 0.1f, EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered, ECrowdAvoidanceQuality::Low},
+  };
+  static_assert(UE_ARRAY_COUNT(TierSettings) == static_cast<int32>(EEnemyLOD::EEL_MAX), "One settings entry per AI LOD tier");
+
+  return TierSettings[static_cast<int32>(Tier)];
+}
+
+EEnemyLOD UEnemyLODSubsystem::EvaluateTier(const AEnemy *Enemy, EEnemyLOD CurrentTier, const TArray<FVector> &PlayerLocations) const
+{
+  const FVector EnemyLocation = Enemy->GetActorLocation();
+  float DistanceSquared = TNumericLimits<float>::Max();
+  for (const FVector &PlayerLocation : PlayerLocations)
+  {
+    DistanceSquared = FMath::Min(DistanceSquared, FVector::DistSquared(EnemyLocation, PlayerLocation));
+  }
+  const float Distance = FMath::Sqrt(DistanceSquared);
+
+  const float ReducedDistance = CVarEnemyLODReducedDistance.GetValueOnGameThread();
+  const float MinimalDistance = CVarEnemyLODMinimalDistance.GetValueOnGameThread();
+  const float Hysteresis = CVarEnemyLODHysteresis.GetValueOnGameThread();
+
+  // Boundaries are pushed out by the hysteresis for enemies already in the tier above
+  const int32 CurrentIndex = static_cast<int32>(CurrentTier);
+  const float ReducedBoundary = ReducedDistance + (CurrentIndex < 1 ? Hysteresis : -Hysteresis);
+  const float MinimalBoundary = MinimalDistance + (CurrentIndex < 2 ? Hysteresis : -Hysteresis);
+
+  int32 TargetIndex = Distance > MinimalBoundary ? 2 : (Distance > ReducedBoundary ? 1 : 0);
+
+  // Unseen enemies drop a tier, unless right next to a player. Dedicated servers render nothing and rank by distance only
+  const bool bNear = Distance < CVarEnemyLODNearDistance.GetValueOnGameThread();
+  if (!bNear && !GetWorld()->IsNetMode(NM_DedicatedServer) && !Enemy->WasRecentlyRendered(0.5f))
+  {
+    TargetIndex = FMath::Min(TargetIndex + 1, 2);
+  }
+
+  // One step at a time, so the behavior changes smoothly
+  const int32 NewIndex = CurrentIndex + FMath::Clamp(TargetIndex - CurrentIndex, -1, 1);
+  return static_cast<EEnemyLOD>(NewIndex);
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Navigation/CrowdManager.h"
+#include "EnemyLOD.h"
+#include "EnemyLODSubsystem.generated.h"
+
+class AEnemy;
+
+/** What an enemy updates, and how often, in one AI LOD tier */
+struct FEnemyLODSettings
+{
+  /** Seconds between behavior tree ticks, 0 for every frame */
+  float BehaviorTreeTickInterval;
+
+  /** Substeps CharacterMovement may take per tick, movement itself ticks every frame so chasing enemies don't step or tunnel */
+  int32 MaxSimulationIterations;
+
+  /** Frames between perception updates, 1 for every frame */
+  int32 PerceptionFrameInterval;
+
+  /** Seconds between skeletal mesh ticks, 0 for every frame */
+  float AnimationTickInterval;
+
+  /** When the mesh updates its pose */
+  EVisibilityBasedAnimTickOption AnimationTickOption;
+
+  /** Quality of the crowd avoidance while following a path */
+  ECrowdAvoidanceQuality::Type CrowdAvoidanceQuality;
+};
+
+/**
+ * AI level of detail of every enemy. Enemies are ranked by their distance to the closest player and by
+ * whether they were rendered recently, and lower tiers update their behavior tree, perception and animation
+ * less often, simulate movement with fewer substeps, and avoid each other more coarsely. A tier only changes
+ * one step per evaluation and past a hysteresis band, so enemies on a tier boundary don't flicker between tiers
+ */
+UCLASS()
+class MONSTERSHOOTER_API UEnemyLODSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Starts ranking Enemy, it begins in the full tier */
+  void RegisterEnemy(AEnemy *Enemy);
+
+  void UnregisterEnemy(AEnemy *Enemy);
+
+  /** Update settings of a tier */
+  static const FEnemyLODSettings &GetTierSettings(EEnemyLOD Tier);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Tier Enemy should move to from CurrentTier */
+  EEnemyLOD EvaluateTier(const AEnemy *Enemy, EEnemyLOD CurrentTier, const TArray<FVector> &PlayerLocations) const;
+
+  TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+  /** Next enemy to evaluate, enemies are spread over several frames */
+  int32 NextEnemy = 0;
+
+  /** Fraction of an enemy left over from the previous frame's evaluation quota */
+  float EvaluationCarry = 0.f;
+};
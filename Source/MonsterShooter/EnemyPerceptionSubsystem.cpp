@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyPerceptionSubsystem.h"
+#include "Enemy.h"
+#include "EnemyLODSubsystem.h"
+#include "ShooterCharacter.h"
+
+static TAutoConsoleVariable<float> CVarPerceptionCellSize(
+    TEXT("MonsterShooter.AI.PerceptionCellSize"),
+    1000.f,
+    TEXT("Size of the spatial hash cells used for enemy perception, around the largest agro radius works best."),
+    ECVF_Default);
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  Enemies.RemoveAllSwap([](const FPerceivingEnemy &Perceiving)
+                        { return !Perceiving.Enemy.IsValid(); },
+                        false);
+  UpdateFrame++;
+
+  // Runs without players too, so enemies see them leave
+  BuildSpatialHash();
+
+  for (int32 i = 0; i < Enemies.Num(); i++)
+  {
+    FPerceivingEnemy &Perceiving = Enemies[i];
+    AEnemy *Enemy = Perceiving.Enemy.Get();
+
+    // Lower LOD tiers are updated every few frames, staggered by index
+    const int32 FrameInterval = UEnemyLODSubsystem::GetTierSettings(Enemy->GetAILODTier()).PerceptionFrameInterval;
+    if (FrameInterval > 1 && (UpdateFrame + i) % FrameInterval != 0)
+      continue;
+
+    const FVector EnemyLocation = Enemy->GetActorLocation();
+
+    AShooterCharacter *AgroPlayer = FindClosestPlayer(EnemyLocation, Enemy->GetAgroRadius());
+    const bool bPlayerInAgro = AgroPlayer != nullptr;
+    if (bPlayerInAgro && !Perceiving.bPlayerInAgro)
+    {
+      Enemy->OnPlayerEnteredAgro(AgroPlayer);
+    }
+    Perceiving.bPlayerInAgro = bPlayerInAgro;
+
+    AShooterCharacter *AttackRangePlayer = FindClosestPlayer(EnemyLocation, Enemy->GetCombatRange());
+    const bool bInAttackRange = AttackRangePlayer != nullptr;
+    if (bInAttackRange != Perceiving.bInAttackRange || AttackRangePlayer != Perceiving.AttackRangePlayer.Get())
+    {
+      Enemy->SetInAttackRange(bInAttackRange, AttackRangePlayer);
+      Perceiving.bInAttackRange = bInAttackRange;
+      Perceiving.AttackRangePlayer = AttackRangePlayer;
+    }
+  }
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyPerceptionSubsystem::RegisterEnemy(AEnemy *Enemy)
+{
+  FPerceivingEnemy &Perceiving = Enemies.AddDefaulted_GetRef();
+  Perceiving.Enemy = Enemy;
+}
+
+void UEnemyPerceptionSubsystem::UnregisterEnemy(AEnemy *Enemy)
+{
+  Enemies.RemoveAllSwap([Enemy](const FPerceivingEnemy &Perceiving)
+                        { return Perceiving.Enemy.Get() == Enemy; },
+                        false);
+}
+
+void UEnemyPerceptionSubsystem::BuildSpatialHash()
+{
+  CellSize = FMath::Max(CVarPerceptionCellSize.GetValueOnGameThread(), 100.f);
+  MaxEntryRadius = 0.f;
+
+  // Reset keeps the cell arrays allocated from one frame to the next
+  for (auto &Cell : PlayerCells)
+  {
+    Cell.Value.Reset();
+  }
+
+  for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+  {
+    AShooterCharacter *Player = It->Get() ? Cast<AShooterCharacter>(It->Get()->GetPawn()) : nullptr;
+    if (Player && !Player->IsDead())
+    {
+      const FVector Location = Player->GetActorLocation();
+      const float Radius = Player->GetSimpleCollisionRadius();
+      PlayerCells.FindOrAdd(GetCell(Location)).Add({Player, Location, Radius});
+      MaxEntryRadius = FMath::Max(MaxEntryRadius, Radius);
+    }
+  }
+
+  // Cells nobody used this frame
+  for (auto It = PlayerCells.CreateIterator(); It; ++It)
+  {
+    if (It.Value().Num() == 0)
+    {
+      It.RemoveCurrent();
+    }
+  }
+}
+
+AShooterCharacter *UEnemyPerceptionSubsystem::FindClosestPlayer(const FVector &Location, float Radius) const
+{
+  if (PlayerCells.Num() == 0)
+    return nullptr;
+
+  AShooterCharacter *ClosestPlayer = nullptr;
+  float ClosestDistanceSquared = TNumericLimits<float>::Max();
+
+  ForEachEntryInRadius(PlayerCells, Location, Radius, [&](const FSpatialHashEntry &Entry)
+                       {
+                         // Overlapping the player capsule, like the spheres did
+                         const float Reach = Radius + Entry.Radius;
+                         const float DistanceSquared = FVector::DistSquared(Entry.Location, Location);
+                         if (DistanceSquared <= Reach * Reach && DistanceSquared < ClosestDistanceSquared)
+                         {
+                           ClosestDistanceSquared = DistanceSquared;
+                           ClosestPlayer = static_cast<AShooterCharacter *>(Entry.Actor);
+                         } });
+
+  return ClosestPlayer;
+}
+
+FIntVector UEnemyPerceptionSubsystem::GetCell(const FVector &Location) const
+{
+  return FIntVector(
+      FMath::FloorToInt32(Location.X / CellSize),
+      FMath::FloorToInt32(Location.Y / CellSize),
+      FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+template <typename FunctionType>
+void UEnemyPerceptionSubsystem::ForEachEntryInRadius(
+    const TMap<FIntVector, TArray<FSpatialHashEntry>> &Cells,
+    const FVector &Location,
+    float Radius,
+    FunctionType Function) const
+{
+  // Entries can reach out of their cell by their own radius
+  const float Reach = Radius + MaxEntryRadius;
+  const FIntVector MinCell = GetCell(Location - FVector(Reach));
+  const FIntVector MaxCell = GetCell(Location + FVector(Reach));
+
+  for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+  {
+    for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+    {
+      for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+      {
+        if (const TArray<FSpatialHashEntry> *Entries = Cells.Find(FIntVector(X, Y, Z)))
+        {
+          for (const FSpatialHashEntry &Entry : *Entries)
+          {
+            Function(Entry);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemy;
+class AShooterCharacter;
+
+/** Perception state of one enemy, compared against each update to only report changes */
+struct FPerceivingEnemy
+{
+  TWeakObjectPtr<AEnemy> Enemy;
+
+  /** If a player was inside the agro radius at the last update */
+  bool bPlayerInAgro = false;
+
+  /** If a player was inside the combat range at the last update */
+  bool bInAttackRange = false;
+
+  /** Closest player inside the combat range at the last update */
+  TWeakObjectPtr<AShooterCharacter> AttackRangePlayer;
+};
+
+/** Actor stored in a spatial hash cell */
+struct FSpatialHashEntry
+{
+  AActor *Actor;
+  FVector Location;
+
+  /** Collision radius, added to the perception radius as the overlap spheres did */
+  float Radius;
+};
+
+/**
+ * Agro and attack range tests of every enemy in one pass per frame, replacing the overlap spheres.
+ * Players are bucketed into a uniform spatial hash each frame, and each enemy only looks at the
+ * cells its radii cover. Enemies in lower AI LOD tiers are updated every few frames.
+ * Enemies are only notified when what they perceive changes
+ */
+UCLASS()
+class MONSTERSHOOTER_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  void RegisterEnemy(AEnemy *Enemy);
+
+  void UnregisterEnemy(AEnemy *Enemy);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Buckets the player characters */
+  void BuildSpatialHash();
+
+  /** Closest player within Radius of Location, null if there is none */
+  AShooterCharacter *FindClosestPlayer(const FVector &Location, float Radius) const;
+
+  /** Cell containing Location */
+  FIntVector GetCell(const FVector &Location) const;
+
+  /** Visits the entries of every cell overlapping the box around Location */
+  template <typename FunctionType>
+  void ForEachEntryInRadius(const TMap<FIntVector, TArray<FSpatialHashEntry>> &Cells, const FVector &Location, float Radius, FunctionType Function) const;
+
+  TArray<FPerceivingEnemy> Enemies;
+
+  /** Spatial hash of the players, rebuilt every frame */
+  TMap<FIntVector, TArray<FSpatialHashEntry>> PlayerCells;
+
+  /** Cell size used to build the hash this frame */
+  float CellSize = 1000.f;
+
+  /** Largest collision radius in the hash this frame */
+  float MaxEntryRadius = 0.f;
+
+  /** Frames since the subsystem started, staggers the updates of lower LOD tiers */
+  uint32 UpdateFrame = 0;
+};
@@ -7,6 +7,7 @@
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "ShooterCharacter.h"
+#include "MonsterShooter.h"
 
 // Sets default values
 AEnemySpawner::AEnemySpawner() : EnemyClass(AEnemy::StaticClass()),
@@ -21,8 +22,13 @@ AEnemySpawner::AEnemySpawner() : EnemyClass(AEnemy::StaticClass()),
 
 	SpawnAreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("SpawnAreaSphere"));
 	SetRootComponent(SpawnAreaSphere);
+	// Spawner volumes are invisible, shots and item traces go through them
+	SpawnAreaSphere->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
+	SpawnAreaSphere->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Ignore);
 
 	TriggerBox = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerBox"));
+	TriggerBox->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
+	TriggerBox->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Ignore);
 }
 
 // Called when the game starts or when spawned
@@ -65,9 +71,9 @@ void AEnemySpawner::SpawnEnemies()
 		EnemiesSpawned.Add(Enemy);
 
 		auto EnemyController = Cast<AEnemyController>(Enemy->GetController());
-		if (EnemyController && EnemyController->GetBlackboardComponent() && bAgressive && Player)
+		if (EnemyController && bAgressive && Player)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("Target"), Player);
+			EnemyController->GetEnemyBlackboard().SetTarget(Player);
 		}
 	}
 
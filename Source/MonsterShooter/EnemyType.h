@@ -0,0 +1,12 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EEnemyType : uint8
+{
+  EET_Grux UMETA(DisplayName = "Grux"),
+  EET_Warchief UMETA(DisplayName = "Warchief"),
+  EET_Gruxling UMETA(DisplayName = "Gruxling"),
+  EET_Qilin UMETA(DisplayName = "Qilin"),
+
+  EET_MAX UMETA(DisplayName = "DefaultMAX")
+};
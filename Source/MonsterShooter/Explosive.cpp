@@ -5,8 +5,9 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "Sound/SoundCue.h"
 #include "Components/SphereComponent.h"
-#include "GameFramework/Character.h"
-#include "Kismet/GameplayStatics.h"
+#include "DamageQueueSubsystem.h"
+#include "FXPoolSubsystem.h"
+#include "MonsterShooter.h"
 
 // Sets default values
 AExplosive::AExplosive() : BaseDamage(100.f)
@@ -19,6 +20,9 @@ AExplosive::AExplosive() : BaseDamage(100.f)
 
   OverlapSphere = CreateDefaultSubobject<USphereComponent>(TEXT("OverlapSphere"));
   OverlapSphere->SetupAttachment(GetRootComponent());
+  // Only the barrel itself is shot, not its blast radius
+  OverlapSphere->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
+  OverlapSphere->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Ignore);
 }
 
 // Called when the game starts or when spawned
@@ -42,25 +46,22 @@ void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor *Shooter,
 
   if (ExplodeParticles)
   {
-    UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplodeParticles, HitResult.Location, FRotator(0.f), true);
+    UFXPoolSubsystem::SpawnPooledEmitter(this, ExplodeParticles, FTransform(HitResult.Location));
   }
 
   // Apply explosive damage
-  TArray<AActor *> OverlappingActors;
-  GetOverlappingActors(OverlappingActors, ACharacter::StaticClass());
-
-  UGameplayStatics::ApplyRadialDamageWithFalloff(
-      GetWorld(),
-      BaseDamage,
-      BaseDamage * 0.1f,
-      GetActorLocation(),
-      OverlapSphere->GetScaledSphereRadius() * 0.3f,
-      OverlapSphere->GetScaledSphereRadius(),
-      100.f,
-      UDamageType::StaticClass(),
-      {},
-      this,
-      InstigatorController);
+  if (auto DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>())
+  {
+    DamageQueue->QueueRadialDamage(
+        BaseDamage,
+        BaseDamage * 0.1f,
+        GetActorLocation(),
+        OverlapSphere->GetScaledSphereRadius() * 0.3f,
+        OverlapSphere->GetScaledSphereRadius(),
+        100.f,
+        this,
+        InstigatorController);
+  }
 
   Destroy();
 }
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FXPoolSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "GameFramework/WorldSettings.h"
+
+static TAutoConsoleVariable<int32> CVarFXSpawnCap(
+    TEXT("MonsterShooter.FX.SpawnCapPerFrame"),
+    24,
+    TEXT("Maximum number of pooled effects of the same particle system spawned in one frame, 0 for no limit."),
+    ECVF_Default);
+
+void UFXPoolSubsystem::Deinitialize()
+{
+  for (TPair<UParticleSystem *, FFXPool> &Pool : Pools)
+  {
+    for (UParticleSystemComponent *Component : Pool.Value.Components)
+    {
+      if (IsValid(Component))
+      {
+        Component->DestroyComponent();
+      }
+    }
+  }
+  Pools.Empty();
+
+  Super::Deinitialize();
+}
+
+bool UFXPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+UParticleSystemComponent *UFXPoolSubsystem::SpawnPooledEmitter(const UObject *WorldContextObject, UParticleSystem *Template, const FTransform &Transform)
+{
+  UWorld *World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+  if (!World || !Template)
+    return nullptr;
+
+  // Looping systems never finish, so they would never go back to a pool
+  auto FXPool = World->GetSubsystem<UFXPoolSubsystem>();
+  if (FXPool && !Template->IsLooping())
+  {
+    return FXPool->SpawnEmitter(Template, Transform);
+  }
+
+  return UGameplayStatics::SpawnEmitterAtLocation(World, Template, Transform);
+}
+
+UParticleSystemComponent *UFXPoolSubsystem::SpawnEmitter(UParticleSystem *Template, const FTransform &Transform)
+{
+  if (!Template || Template->IsLooping() || GetWorld()->IsNetMode(NM_DedicatedServer))
+    return nullptr;
+
+  FFXPool &Pool = Pools.FindOrAdd(Template);
+  if (Pool.SpawnFrame != GFrameCounter)
+  {
+    Pool.SpawnFrame = GFrameCounter;
+    Pool.SpawnsThisFrame = 0;
+  }
+
+  const int32 SpawnCap = CVarFXSpawnCap.GetValueOnGameThread();
+  if (SpawnCap > 0 && Pool.SpawnsThisFrame >= SpawnCap)
+    return nullptr;
+  Pool.SpawnsThisFrame++;
+
+  UParticleSystemComponent *Component = nullptr;
+  while (!Component && Pool.FreeComponents.Num() > 0)
+  {
+    Component = Pool.FreeComponents.Pop(false);
+    if (!IsValid(Component))
+    {
+      Component = nullptr;
+    }
+  }
+  if (!Component)
+  {
+    Component = CreateComponent(Template);
+  }
+
+  Component->SetWorldTransform(Transform);
+  Component->ActivateSystem(true);
+  return Component;
+}
+
+void UFXPoolSubsystem::Prewarm(UParticleSystem *Template, int32 Count)
+{
+  if (!Template || Template->IsLooping() || GetWorld()->IsNetMode(NM_DedicatedServer))
+    return;
+
+  FFXPool &Pool = Pools.FindOrAdd(Template);
+  while (Pool.Components.Num() < Count)
+  {
+    Pool.FreeComponents.Add(CreateComponent(Template));
+  }
+}
+
+UParticleSystemComponent *UFXPoolSubsystem::CreateComponent(UParticleSystem *Template)
+{
+  UWorld *World = GetWorld();
+
+  // Same outer as the components of UGameplayStatics::SpawnEmitterAtLocation, but never auto destroyed
+  UParticleSystemComponent *Component = NewObject<UParticleSystemComponent>(World->GetWorldSettings());
+  Component->bAutoActivate = false;
+  Component->bAutoDestroy = false;
+  Component->SetAbsolute(true, true, true);
+  Component->SetTemplate(Template);
+  Component->OnSystemFinished.AddDynamic(this, &UFXPoolSubsystem::OnEmitterFinished);
+  Component->RegisterComponentWithWorld(World);
+
+  Pools.FindOrAdd(Template).Components.Add(Component);
+  return Component;
+}
+
+void UFXPoolSubsystem::OnEmitterFinished(UParticleSystemComponent *Component)
+{
+  FFXPool *Pool = Component ? Pools.Find(Component->Template) : nullptr;
+  if (Pool)
+  {
+    Pool->FreeComponents.AddUnique(Component);
+  }
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/** Components of one particle template */
+USTRUCT()
+struct FFXPool
+{
+  GENERATED_BODY()
+
+  /** Every component created for the template */
+  UPROPERTY()
+  TArray<UParticleSystemComponent *> Components;
+
+  /** Components that finished playing and can be reused */
+  UPROPERTY()
+  TArray<UParticleSystemComponent *> FreeComponents;
+
+  /** Frame SpawnsThisFrame belongs to */
+  uint64 SpawnFrame = 0;
+
+  int32 SpawnsThisFrame = 0;
+};
+
+/**
+ * Pool of particle components for one-shot effects (muzzle flashes, beams, impacts, blood).
+ * Components are created ahead of time, go back to the pool when their system finishes,
+ * and each template can only spawn a limited number of effects per frame. Looping templates are never pooled
+ */
+UCLASS()
+class MONSTERSHOOTER_API UFXPoolSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Deinitialize() override;
+
+  /** Plays Template at Transform with a pooled component, or a regular emitter if the world has no pool or Template loops */
+  static UParticleSystemComponent *SpawnPooledEmitter(const UObject *WorldContextObject, UParticleSystem *Template, const FTransform &Transform);
+
+  /** Plays Template at Transform with a free component of its pool. Null when the template loops or is over its spawn cap this frame */
+  UParticleSystemComponent *SpawnEmitter(UParticleSystem *Template, const FTransform &Transform);
+
+  /** Creates components until the pool of Template has at least Count of them */
+  void Prewarm(UParticleSystem *Template, int32 Count);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  UParticleSystemComponent *CreateComponent(UParticleSystem *Template);
+
+  /** Puts the component back in its pool once its system finished */
+  UFUNCTION()
+  void OnEmitterFinished(UParticleSystemComponent *Component);
+
+  UPROPERTY()
+  TMap<UParticleSystem *, FFXPool> Pools;
+};
@@ -0,0 +1,461 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlowFieldSubsystem.h"
+#include "NavigationSystem.h"
+
+static TAutoConsoleVariable<float> CVarFlowFieldCellSize(
+    TEXT("MonsterShooter.AI.FlowField.CellSize"),
+    100.f,
+    TEXT("Size of a flow field cell, changing it drops every field and cached navmesh height."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldSize(
+    TEXT("MonsterShooter.AI.FlowField.Size"),
+    64,
+    TEXT("Number of cells per side of the field built around each followed target."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldProbeBudget(
+    TEXT("MonsterShooter.AI.FlowField.ProbeBudget"),
+    256,
+    TEXT("Navmesh projections of new cells allowed per frame, over every field."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldExpansionBudget(
+    TEXT("MonsterShooter.AI.FlowField.ExpansionBudget"),
+    2048,
+    TEXT("Cells expanded per frame by the field builds, over every field."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldRebuildInterval(
+    TEXT("MonsterShooter.AI.FlowField.RebuildInterval"),
+    0.2f,
+    TEXT("Minimum seconds between two builds of the field of a target that keeps changing cell."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldSeparationRadius(
+    TEXT("MonsterShooter.AI.FlowField.SeparationRadius"),
+    120.f,
+    TEXT("Distance under which followers steered by a field push away from each other. 0 disables separation."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFlowFieldSeparationWeight(
+    TEXT("MonsterShooter.AI.FlowField.SeparationWeight"),
+    1.f,
+    TEXT("Weight of the separation from other followers against the flow direction."),
+    ECVF_Default);
+
+namespace
+{
+  /** Flow of the cell the target is in, followers head straight for it */
+  constexpr uint8 FlowGoal = 8;
+
+  /** Flow of cells the build didn't reach */
+  constexpr uint8 FlowNone = 255;
+
+  /** Highest height difference between two neighbour cells followers can step over */
+  constexpr float MaxStepHeight = 60.f;
+
+  /** Vertical half extent of the navmesh projection of a cell */
+  constexpr float ProbeHeight = 500.f;
+
+  // Neighbour offsets, orthogonal first then diagonal, and the cost of stepping to each
+  const FIntPoint NeighbourOffsets[8] = {
+      {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+  const float NeighbourCosts[8] = {
+      1.f, 1.f, 1.f, 1.f, UE_SQRT_2, UE_SQRT_2, UE_SQRT_2, UE_SQRT_2};
+}
+
+void UFlowFieldSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  const float NewCellSize = FMath::Max(CVarFlowFieldCellSize.GetValueOnGameThread(), 10.f);
+  if (NewCellSize != CellSize)
+  {
+    CellSize = NewCellSize;
+    CellHeights.Empty();
+    for (FFlowField &Field : Fields)
+    {
+      const TWeakObjectPtr<AActor> Target = Field.Target;
+      Field = FFlowField();
+      Field.Target = Target;
+    }
+  }
+
+  // Forget destroyed followers, and fields nobody follows anymore
+  Followers.RemoveAllSwap([](const FFlowFieldFollower &Follower)
+                          { return !Follower.Pawn.IsValid() || !Follower.Target.IsValid(); },
+                          false);
+  Fields.RemoveAllSwap([this](const FFlowField &Field)
+                       { return !Field.Target.IsValid() ||
+                                !Followers.ContainsByPredicate([&Field](const FFlowFieldFollower &Follower)
+                                                               { return Follower.Target == Field.Target; }); },
+                       false);
+  if (Fields.Num() == 0)
+    return;
+
+  const float Time = GetWorld()->GetTimeSeconds();
+  const float RebuildInterval = CVarFlowFieldRebuildInterval.GetValueOnGameThread();
+  int32 ProbeBudget = CVarFlowFieldProbeBudget.GetValueOnGameThread();
+  int32 ExpansionBudget = CVarFlowFieldExpansionBudget.GetValueOnGameThread();
+
+  for (FFlowField &Field : Fields)
+  {
+    if (!Field.bBuilding && Time - Field.LastBuildTime >= RebuildInterval)
+    {
+      const FIntPoint TargetCell = GetCell(Field.Target->GetActorLocation());
+      if (Field.Size == 0 || TargetCell != Field.Goal)
+      {
+        Field.LastBuildTime = Time;
+        StartBuild(Field);
+      }
+    }
+
+    if (Field.bBuilding)
+    {
+      UpdateBuild(Field, ProbeBudget, ExpansionBudget);
+    }
+  }
+
+  SteerFollowers();
+}
+
+TStatId UFlowFieldSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+bool UFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFlowFieldSubsystem::StartFollowing(APawn *Pawn, AActor *Target)
+{
+  if (!Pawn || !Target)
+    return;
+
+  FFlowFieldFollower *Follower = Followers.FindByPredicate([Pawn](const FFlowFieldFollower &Other)
+                                                           { return Other.Pawn == Pawn; });
+  if (!Follower)
+  {
+    Follower = &Followers.AddDefaulted_GetRef();
+    Follower->Pawn = Pawn;
+  }
+  else if (Follower->Target == Target)
+  {
+    // Already following, keep whether it is in the field until the next steering pass
+    return;
+  }
+  Follower->Target = Target;
+  Follower->bInField = false;
+
+  if (!FindField(Target))
+  {
+    Fields.AddDefaulted_GetRef().Target = Target;
+  }
+}
+
+void UFlowFieldSubsystem::StopFollowing(APawn *Pawn)
+{
+  Followers.RemoveAllSwap([Pawn](const FFlowFieldFollower &Follower)
+                          { return Follower.Pawn == Pawn; },
+                          false);
+}
+
+bool UFlowFieldSubsystem::IsInField(const APawn *Pawn) const
+{
+  const FFlowFieldFollower *Follower = Followers.FindByPredicate([Pawn](const FFlowFieldFollower &Other)
+                                                                 { return Other.Pawn == Pawn; });
+
+  return Follower && Follower->bInField;
+}
+
+bool UFlowFieldSubsystem::SampleFlow(const AActor *Target, const FVector &Location, FVector &OutDirection) const
+{
+  const FFlowField *Field = FindField(Target);
+  if (!Field || Field->Size == 0)
+    return false;
+
+  const FIntPoint LocalCell = GetCell(Location) - Field->Origin;
+  if (LocalCell.X < 0 || LocalCell.Y < 0 || LocalCell.X >= Field->Size || LocalCell.Y >= Field->Size)
+    return false;
+
+  const uint8 Flow = Field->Flow[LocalCell.Y * Field->Size + LocalCell.X];
+  if (Flow == FlowNone)
+    return false;
+
+  if (Flow == FlowGoal)
+  {
+    OutDirection = (Target->GetActorLocation() - Location).GetSafeNormal2D();
+  }
+  else
+  {
+    const FIntPoint &Offset = NeighbourOffsets[Flow];
+    OutDirection = FVector(Offset.X, Offset.Y, 0.f).GetSafeNormal();
+  }
+
+  return true;
+}
+
+void UFlowFieldSubsystem::StartBuild(FFlowField &Field)
+{
+  Field.bBuilding = true;
+  Field.BuildSize = FMath::Clamp(CVarFlowFieldSize.GetValueOnGameThread(), 2, 512);
+  Field.BuildGoal = GetCell(Field.Target->GetActorLocation());
+  Field.BuildOrigin = Field.BuildGoal - FIntPoint(Field.BuildSize / 2);
+
+  // Only cells never seen before are probed, the navmesh is static
+  Field.UnprobedCells.Reset();
+  for (int32 Y = 0; Y < Field.BuildSize; Y++)
+  {
+    for (int32 X = 0; X < Field.BuildSize; X++)
+    {
+      const FIntPoint Cell = Field.BuildOrigin + FIntPoint(X, Y);
+      if (!CellHeights.Contains(Cell))
+      {
+        Field.UnprobedCells.Add(Cell);
+      }
+    }
+  }
+
+  Field.BuildDistances.Init(MAX_flt, Field.BuildSize * Field.BuildSize);
+  Field.OpenCells.Reset();
+
+  const FIntPoint LocalGoal = Field.BuildGoal - Field.BuildOrigin;
+  const int32 GoalIndex = LocalGoal.Y * Field.BuildSize + LocalGoal.X;
+  Field.BuildDistances[GoalIndex] = 0.f;
+  Field.OpenCells.HeapPush(TPair<float, int32>(0.f, GoalIndex), [](const TPair<float, int32> &A, const TPair<float, int32> &B)
+                           { return A.Key < B.Key; });
+}
+
+void UFlowFieldSubsystem::UpdateBuild(FFlowField &Field, int32 &ProbeBudget, int32 &ExpansionBudget)
+{
+  const float ReferenceZ = Field.Target->GetActorLocation().Z;
+  while (Field.UnprobedCells.Num() > 0 && ProbeBudget > 0)
+  {
+    ProbeCell(Field.UnprobedCells.Pop(false), ReferenceZ);
+    ProbeBudget--;
+  }
+
+  // Cells are only expanded once the whole square is probed
+  if (Field.UnprobedCells.Num() > 0)
+    return;
+
+  auto ClosestFirst = [](const TPair<float, int32> &A, const TPair<float, int32> &B)
+  { return A.Key < B.Key; };
+
+  const int32 Size = Field.BuildSize;
+  while (Field.OpenCells.Num() > 0 && ExpansionBudget > 0)
+  {
+    TPair<float, int32> Open;
+    Field.OpenCells.HeapPop(Open, ClosestFirst, false);
+    ExpansionBudget--;
+
+    // Stale entry, the cell was reached by a shorter way since
+    if (Open.Key > Field.BuildDistances[Open.Value])
+      continue;
+
+    const FIntPoint Local(Open.Value % Size, Open.Value / Size);
+    const FIntPoint Cell = Field.BuildOrigin + Local;
+    for (int32 i = 0; i < 8; i++)
+    {
+      const FIntPoint NeighbourLocal = Local + NeighbourOffsets[i];
+      if (NeighbourLocal.X < 0 || NeighbourLocal.Y < 0 || NeighbourLocal.X >= Size || NeighbourLocal.Y >= Size)
+        continue;
+
+      if (!CanStep(Cell, Cell + NeighbourOffsets[i]))
+        continue;
+
+      const int32 NeighbourIndex = NeighbourLocal.Y * Size + NeighbourLocal.X;
+      const float Distance = Open.Key + NeighbourCosts[i];
+      if (Distance < Field.BuildDistances[NeighbourIndex])
+      {
+        Field.BuildDistances[NeighbourIndex] = Distance;
+        Field.OpenCells.HeapPush(TPair<float, int32>(Distance, NeighbourIndex), ClosestFirst);
+      }
+    }
+  }
+
+  if (Field.OpenCells.Num() == 0)
+  {
+    CompleteBuild(Field);
+  }
+}
+
+void UFlowFieldSubsystem::ProbeCell(const FIntPoint &Cell, float ReferenceZ)
+{
+  float Height = NAN;
+
+  UNavigationSystemV1 *NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+  if (NavSystem)
+  {
+    const FVector Center((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, ReferenceZ);
+    FNavLocation NavLocation;
+    if (NavSystem->ProjectPointToNavigation(Center, NavLocation, FVector(CellSize * 0.5f, CellSize * 0.5f, ProbeHeight)))
+    {
+      Height = NavLocation.Location.Z;
+    }
+  }
+
+  CellHeights.Add(Cell, Height);
+}
+
+void UFlowFieldSubsystem::CompleteBuild(FFlowField &Field)
+{
+  const int32 Size = Field.BuildSize;
+  const FIntPoint LocalGoal = Field.BuildGoal - Field.BuildOrigin;
+  const int32 GoalIndex = LocalGoal.Y * Size + LocalGoal.X;
+
+  Field.Flow.SetNumUninitialized(Size * Size);
+  for (int32 Index = 0; Index < Size * Size; Index++)
+  {
+    if (Index == GoalIndex)
+    {
+      Field.Flow[Index] = FlowGoal;
+      continue;
+    }
+
+    Field.Flow[Index] = FlowNone;
+    if (Field.BuildDistances[Index] == MAX_flt)
+      continue;
+
+    // Step to the neighbour closest to the goal
+    const FIntPoint Local(Index % Size, Index / Size);
+    const FIntPoint Cell = Field.BuildOrigin + Local;
+    float BestDistance = Field.BuildDistances[Index];
+    for (int32 i = 0; i < 8; i++)
+    {
+      const FIntPoint NeighbourLocal = Local + NeighbourOffsets[i];
+      if (NeighbourLocal.X < 0 || NeighbourLocal.Y < 0 || NeighbourLocal.X >= Size || NeighbourLocal.Y >= Size)
+        continue;
+
+      const float Distance = Field.BuildDistances[NeighbourLocal.Y * Size + NeighbourLocal.X];
+      if (Distance < BestDistance && CanStep(Cell, Cell + NeighbourOffsets[i]))
+      {
+        BestDistance = Distance;
+        Field.Flow[Index] = i;
+      }
+    }
+  }
+
+  Field.Origin = Field.BuildOrigin;
+  Field.Goal = Field.BuildGoal;
+  Field.Size = Size;
+  Field.bBuilding = false;
+  Field.BuildDistances.Empty();
+  Field.OpenCells.Empty();
+}
+
+void UFlowFieldSubsystem::SteerFollowers()
+{
+  const float SeparationRadius = CVarFlowFieldSeparationRadius.GetValueOnGameThread();
+  const float SeparationWeight = CVarFlowFieldSeparationWeight.GetValueOnGameThread();
+  const bool bSeparate = SeparationRadius > 0.f && SeparationWeight > 0.f;
+
+  // Followers bucketed by cell, so each one only looks at its close neighbours
+  FollowerLocations.Reset();
+  for (auto &Cell : FollowerCells)
+  {
+    Cell.Value.Reset();
+  }
+  for (int32 i = 0; i < Followers.Num(); i++)
+  {
+    const FVector Location = Followers[i].Pawn->GetActorLocation();
+    FollowerLocations.Add(Location);
+    if (bSeparate)
+    {
+      FollowerCells.FindOrAdd(GetCell(Location)).Add(i);
+    }
+  }
+
+  // Cells nobody stands in anymore
+  for (auto It = FollowerCells.CreateIterator(); It; ++It)
+  {
+    if (It.Value().Num() == 0)
+    {
+      It.RemoveCurrent();
+    }
+  }
+
+  const int32 CellReach = FMath::CeilToInt32(SeparationRadius / CellSize);
+  for (int32 i = 0; i < Followers.Num(); i++)
+  {
+    FFlowFieldFollower &Follower = Followers[i];
+    const FVector &Location = FollowerLocations[i];
+
+    FVector Direction;
+    Follower.bInField = SampleFlow(Follower.Target.Get(), Location, Direction);
+    if (!Follower.bInField)
+      continue;
+
+    // Crowd avoidance only steers path following moves, followers in the field push each other apart here instead
+    FVector Separation = FVector::ZeroVector;
+    if (bSeparate)
+    {
+      const FIntPoint Cell = GetCell(Location);
+      for (int32 Y = -CellReach; Y <= CellReach; Y++)
+      {
+        for (int32 X = -CellReach; X <= CellReach; X++)
+        {
+          const TArray<int32> *Neighbours = FollowerCells.Find(Cell + FIntPoint(X, Y));
+          if (!Neighbours)
+            continue;
+
+          for (const int32 Neighbour : *Neighbours)
+          {
+            const FVector Away = (Location - FollowerLocations[Neighbour]) * FVector(1.f, 1.f, 0.f);
+            const float Distance = Away.Size();
+            if (Neighbour == i || Distance >= SeparationRadius || Distance < KINDA_SMALL_NUMBER)
+              continue;
+
+            // Stronger the closer they are
+            Separation += Away / Distance * (1.f - Distance / SeparationRadius);
+          }
+        }
+      }
+    }
+
+    Follower.Pawn->AddMovementInput((Direction + Separation * SeparationWeight).GetSafeNormal2D());
+  }
+}
+
+bool UFlowFieldSubsystem::CanStep(const FIntPoint &From, const FIntPoint &To) const
+{
+  const float *FromHeight = CellHeights.Find(From);
+  const float *ToHeight = CellHeights.Find(To);
+  if (!FromHeight || !ToHeight || FMath::IsNaN(*FromHeight) || FMath::IsNaN(*ToHeight))
+    return false;
+
+  if (FMath::Abs(*FromHeight - *ToHeight) > MaxStepHeight)
+    return false;
+
+  // Diagonal steps don't cut corners
+  if (From.X != To.X && From.Y != To.Y)
+  {
+    const float *CornerX = CellHeights.Find(FIntPoint(To.X, From.Y));
+    const float *CornerY = CellHeights.Find(FIntPoint(From.X, To.Y));
+    if (!CornerX || !CornerY || FMath::IsNaN(*CornerX) || FMath::IsNaN(*CornerY))
+      return false;
+  }
+
+  return true;
+}
+
+FIntPoint UFlowFieldSubsystem::GetCell(const FVector &Location) const
+{
+  return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+FFlowField *UFlowFieldSubsystem::FindField(const AActor *Target)
+{
+  return Fields.FindByPredicate([Target](const FFlowField &Field)
+                                { return Field.Target.Get() == Target; });
+}
+
+const FFlowField *UFlowFieldSubsystem::FindField(const AActor *Target) const
+{
+  return Fields.FindByPredicate([Target](const FFlowField &Field)
+                                { return Field.Target.Get() == Target; });
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlowFieldSubsystem.generated.h"
+
+/** Distance field toward one target, over a square of cells centered on it */
+struct FFlowField
+{
+  TWeakObjectPtr<AActor> Target;
+
+  /** Cell of the lower corner and number of cells per side of the completed field */
+  FIntPoint Origin = FIntPoint::ZeroValue;
+  int32 Size = 0;
+
+  /** Per cell, index of the neighbour to step to, with special values for the goal and cells without flow */
+  TArray<uint8> Flow;
+
+  /** Cell the target was in when the completed field was built */
+  FIntPoint Goal = FIntPoint::ZeroValue;
+
+  /** Time the last build started */
+  float LastBuildTime = -BIG_NUMBER;
+
+  // Build in progress, swapped into the completed field once every cell is reached
+  bool bBuilding = false;
+  FIntPoint BuildOrigin = FIntPoint::ZeroValue;
+  FIntPoint BuildGoal = FIntPoint::ZeroValue;
+  int32 BuildSize = 0;
+
+  /** Cells of the build without a cached navmesh height yet */
+  TArray<FIntPoint> UnprobedCells;
+
+  /** Distance to the goal of every cell, and cells to expand as (distance, index) */
+  TArray<float> BuildDistances;
+  TArray<TPair<float, int32>> OpenCells;
+};
+
+/** Pawn steered along the field of its target */
+struct FFlowFieldFollower
+{
+  TWeakObjectPtr<APawn> Pawn;
+  TWeakObjectPtr<AActor> Target;
+
+  /** If the pawn was inside its field with a flow to follow on the last steering pass */
+  bool bInField = false;
+};
+
+/**
+ * Shared navigation toward the targets hordes chase. Each followed target gets one distance field over the
+ * navmesh around it, rebuilt over a few frames whenever the target changes cell, and every follower is steered
+ * in one pass per frame by looking up the cell it stands in. Walkable heights are probed once per cell and cached.
+ * Steered followers are moved by input, outside of the crowd avoidance of path following, so the same pass pushes
+ * followers closer than a separation radius apart.
+ * Fields are deliberately rebuilt in full rather than repaired: a moving goal changes the distance of every cell,
+ * so the whole Dijkstra pass runs again, time-sliced by the expansion budget and at most once per rebuild interval,
+ * while only the navmesh probes, the expensive part, are reused. Followers keep the previous field until the new one completes.
+ * The field is 2D with one walkable height per cell, followers outside it or on cells it doesn't reach are left
+ * to normal pathfinding
+ */
+UCLASS()
+class MONSTERSHOOTER_API UFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Starts steering Pawn toward Target, building a field for Target if it has none. Does nothing if Pawn already follows Target */
+  void StartFollowing(APawn *Pawn, AActor *Target);
+
+  void StopFollowing(APawn *Pawn);
+
+  /** If Pawn was steered by a field this frame, false when it should pathfind on its own */
+  bool IsInField(const APawn *Pawn) const;
+
+  /** Direction to move in from Location toward Target, false if Location has no flow in the field of Target */
+  bool SampleFlow(const AActor *Target, const FVector &Location, FVector &OutDirection) const;
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Starts a build of Field centered on the current cell of its target */
+  void StartBuild(FFlowField &Field);
+
+  /** Probes and expands cells of the build of Field within the remaining budgets, completing it when done */
+  void UpdateBuild(FFlowField &Field, int32 &ProbeBudget, int32 &ExpansionBudget);
+
+  /** Caches the walkable height of a cell, projecting its center onto the navmesh */
+  void ProbeCell(const FIntPoint &Cell, float ReferenceZ);
+
+  /** Writes the neighbour to step to of every cell of the build and makes it the completed field */
+  void CompleteBuild(FFlowField &Field);
+
+  /** Applies the flow of the field of every follower as movement input */
+  void SteerFollowers();
+
+  /** If a step between two cells is walkable */
+  bool CanStep(const FIntPoint &From, const FIntPoint &To) const;
+
+  FIntPoint GetCell(const FVector &Location) const;
+
+  FFlowField *FindField(const AActor *Target);
+  const FFlowField *FindField(const AActor *Target) const;
+
+  TArray<FFlowField> Fields;
+
+  TArray<FFlowFieldFollower> Followers;
+
+  /** Navmesh height of every probed cell, NAN for cells without navmesh */
+  TMap<FIntPoint, float> CellHeights;
+
+  // Follower locations of the steering pass, bucketed by cell for the separation between followers
+  TArray<FVector> FollowerLocations;
+  TMap<FIntPoint, TArray<int32>> FollowerCells;
+
+  /** Cell size the heights were probed with, the cache is dropped when it changes */
+  float CellSize = 100.f;
+};
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ImpactFXSubsystem.h"
+#include "NiagaraComponent.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraSystem.h"
+#include "NiagaraDataInterfaceArrayFunctionLibrary.h"
+#include "Kismet/GameplayStatics.h"
+#include "FXPoolSubsystem.h"
+
+// User parameters read by the batch system
+static const FName ImpactCountParam(TEXT("ImpactCount"));
+static const FName ImpactPositionsParam(TEXT("ImpactPositions"));
+static const FName ImpactNormalsParam(TEXT("ImpactNormals"));
+static const FName ImpactTypesParam(TEXT("ImpactTypes"));
+static const FName ImpactSurfacesParam(TEXT("ImpactSurfaces"));
+static const FName ImpactIntensitiesParam(TEXT("ImpactIntensities"));
+
+void UImpactFXSubsystem::OnWorldBeginPlay(UWorld &InWorld)
+{
+  Super::OnWorldBeginPlay(InWorld);
+
+  if (InWorld.IsNetMode(NM_DedicatedServer))
+    return;
+
+  // Path to the batch system, optional
+  const FString ImpactSystemPath{TEXT("/Script/Niagara.NiagaraSystem'/Game/_Game/FX/NS_ImpactBatch.NS_ImpactBatch'")};
+  UNiagaraSystem *ImpactSystem = Cast<UNiagaraSystem>(StaticLoadObject(UNiagaraSystem::StaticClass(), nullptr, *ImpactSystemPath, nullptr, LOAD_NoWarn));
+  if (!ImpactSystem)
+    return;
+
+  ImpactComponent = UNiagaraFunctionLibrary::SpawnSystemAtLocation(
+      &InWorld,
+      ImpactSystem,
+      FVector::ZeroVector,
+      FRotator::ZeroRotator,
+      FVector(1.f),
+      false,
+      true,
+      ENCPoolMethod::None,
+      false);
+
+  if (ImpactComponent)
+  {
+    // Effects can be anywhere in the level, the system is never culled by its bounds
+    ImpactComponent->SetSystemFixedBounds(FBox(FVector(-HALF_WORLD_MAX), FVector(HALF_WORLD_MAX)));
+  }
+}
+
+void UImpactFXSubsystem::Deinitialize()
+{
+  if (IsValid(ImpactComponent))
+  {
+    ImpactComponent->DestroyComponent();
+  }
+  ImpactComponent = nullptr;
+
+  Super::Deinitialize();
+}
+
+void UImpactFXSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  FlushImpacts();
+}
+
+TStatId UImpactFXSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactFXSubsystem, STATGROUP_Tickables);
+}
+
+bool UImpactFXSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UImpactFXSubsystem::SpawnImpact(
+    const UObject *WorldContextObject,
+    EImpactType Type,
+    const FVector &Location,
+    const FVector &Normal,
+    int32 SurfaceType,
+    float Intensity,
+    UParticleSystem *FallbackTemplate)
+{
+  UWorld *World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+  if (!World)
+    return;
+
+  if (auto ImpactFX = World->GetSubsystem<UImpactFXSubsystem>())
+  {
+    ImpactFX->AddImpact(Type, Location, Normal, SurfaceType, Intensity, FallbackTemplate);
+    return;
+  }
+
+  SpawnFallback(World, Type, Location, Normal, FallbackTemplate);
+}
+
+void UImpactFXSubsystem::SpawnBulletImpact(const UObject *WorldContextObject, EImpactType Type, const FHitResult &Hit, float Intensity, UParticleSystem *FallbackTemplate)
+{
+  SpawnImpact(
+      WorldContextObject,
+      Type,
+      Hit.Location,
+      Hit.ImpactNormal,
+      static_cast<int32>(UGameplayStatics::GetSurfaceType(Hit)),
+      Intensity,
+      FallbackTemplate);
+}
+
+void UImpactFXSubsystem::SpawnFallback(const UObject *WorldContextObject, EImpactType Type, const FVector &Location, const FVector &Normal, UParticleSystem *FallbackTemplate)
+{
+  // Muzzle flashes face along the barrel, the other effects keep the default rotation
+  const FTransform FallbackTransform = Type == EImpactType::EIT_MuzzleFlash
+                                          ? FTransform(Normal.Rotation(), Location)
+                                          : FTransform(Location);
+  UFXPoolSubsystem::SpawnPooledEmitter(WorldContextObject, FallbackTemplate, FallbackTransform);
+}
+
+void UImpactFXSubsystem::AddImpact(
+    EImpactType Type,
+    const FVector &Location,
+    const FVector &Normal,
+    int32 SurfaceType,
+    float Intensity,
+    UParticleSystem *FallbackTemplate)
+{
+  if (!IsValid(ImpactComponent))
+  {
+    SpawnFallback(this, Type, Location, Normal, FallbackTemplate);
+    return;
+  }
+
+  Positions.Add(Location);
+  Normals.Add(Normal);
+  Types.Add(static_cast<int32>(Type));
+  SurfaceTypes.Add(SurfaceType);
+  Intensities.Add(Intensity);
+}
+
+void UImpactFXSubsystem::FlushImpacts()
+{
+  const int32 ImpactCount = Positions.Num();
+
+  // Nothing new, and the system already knows there is nothing to spawn
+  if (!IsValid(ImpactComponent) || (ImpactCount == 0 && LastFlushCount == 0))
+    return;
+
+  UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(ImpactComponent, ImpactPositionsParam, Positions);
+  UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(ImpactComponent, ImpactNormalsParam, Normals);
+  UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayInt32(ImpactComponent, ImpactTypesParam, Types);
+  UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayInt32(ImpactComponent, ImpactSurfacesParam, SurfaceTypes);
+  UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayFloat(ImpactComponent, ImpactIntensitiesParam, Intensities);
+  // The system spawns ImpactCount particles this frame, one per array entry
+  ImpactComponent->SetVariableInt(ImpactCountParam, ImpactCount);
+
+  LastFlushCount = ImpactCount;
+  Positions.Reset();
+  Normals.Reset();
+  Types.Reset();
+  SurfaceTypes.Reset();
+  Intensities.Reset();
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactType.h"
+#include "ImpactFXSubsystem.generated.h"
+
+class UParticleSystem;
+
+/**
+ * Renders every impact, blood splash and muzzle flash of a frame with one long-lived Niagara system.
+ * Effects are collected in arrays during the frame and handed to the system once, through its user array
+ * parameters, instead of spawning one emitter per effect. Falls back to pooled Cascade emitters
+ * when the Niagara system asset is missing, and SpawnImpact does the same in worlds without this subsystem
+ */
+UCLASS()
+class MONSTERSHOOTER_API UImpactFXSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void OnWorldBeginPlay(UWorld &InWorld) override;
+  virtual void Deinitialize() override;
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Adds an effect to the batch of the world, or spawns FallbackTemplate from the FX pool if the world has no batch subsystem */
+  static void SpawnImpact(
+      const UObject *WorldContextObject,
+      EImpactType Type,
+      const FVector &Location,
+      const FVector &Normal,
+      int32 SurfaceType,
+      float Intensity,
+      UParticleSystem *FallbackTemplate);
+
+  /** SpawnImpact for a bullet hit, with the surface it hit */
+  static void SpawnBulletImpact(const UObject *WorldContextObject, EImpactType Type, const FHitResult &Hit, float Intensity, UParticleSystem *FallbackTemplate);
+
+  /** Adds an effect to this frame's batch, FallbackTemplate is spawned instead when there is no batch system */
+  void AddImpact(
+      EImpactType Type,
+      const FVector &Location,
+      const FVector &Normal,
+      int32 SurfaceType,
+      float Intensity,
+      UParticleSystem *FallbackTemplate);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Spawns FallbackTemplate as a pooled emitter in place of a batched effect */
+  static void SpawnFallback(const UObject *WorldContextObject, EImpactType Type, const FVector &Location, const FVector &Normal, UParticleSystem *FallbackTemplate);
+
+  /** Hands the effects of this frame to the Niagara system */
+  void FlushImpacts();
+
+  /** Long-lived system instance reading the batched effects */
+  UPROPERTY()
+  class UNiagaraComponent *ImpactComponent;
+
+  // Effects of the current frame, one entry per effect at the same index in every array
+  TArray<FVector> Positions;
+  TArray<FVector> Normals;
+  TArray<int32> Types;
+  TArray<int32> SurfaceTypes;
+  TArray<float> Intensities;
+
+  /** Number of effects handed to the system last frame */
+  int32 LastFlushCount = 0;
+};
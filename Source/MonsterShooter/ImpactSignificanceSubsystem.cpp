@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ImpactSignificanceSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Sound/SoundBase.h"
+#include "Components/PrimitiveComponent.h"
+#include "ImpactFXSubsystem.h"
+#include "EnemyAudioSubsystem.h"
+
+static TAutoConsoleVariable<int32> CVarImpactBudget(
+    TEXT("MonsterShooter.FX.ImpactBudget"),
+    12,
+    TEXT("Maximum number of impact effects played per frame, the most significant ones are kept. 0 for no limit."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarImpactCullDistance(
+    TEXT("MonsterShooter.FX.ImpactCullDistance"),
+    5000.f,
+    TEXT("Distance from the camera past which impact effects are dropped."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarImpactMergeWindow(
+    TEXT("MonsterShooter.FX.ImpactMergeWindow"),
+    0.08f,
+    TEXT("Seconds during which repeated hits on the same target are merged into one impact effect."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarImpactMergeCellSize(
+    TEXT("MonsterShooter.FX.ImpactMergeCellSize"),
+    100.f,
+    TEXT("Size of the areas of static surfaces whose hits are merged together."),
+    ECVF_Default);
+
+void UImpactSignificanceSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  FlushImpacts();
+}
+
+TStatId UImpactSignificanceSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UImpactSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UImpactSignificanceSubsystem::QueueImpact(
+    AActor *Target,
+    const FHitResult &Hit,
+    USoundBase *Sound,
+    UParticleSystem *Particles,
+    USoundConcurrency *SoundConcurrency)
+{
+  // Nobody to see or hear it
+  if (GetWorld()->IsNetMode(NM_DedicatedServer))
+    return;
+
+  const FImpactMergeKey Key = GetMergeKey(Target, Hit);
+
+  // Hits on the same target this frame only add to the first one
+  for (FImpactEvent &Impact : PendingImpacts)
+  {
+    if (Impact.Key == Key)
+    {
+      Impact.MergedHits++;
+      return;
+    }
+  }
+
+  FImpactEvent &Impact = PendingImpacts.AddDefaulted_GetRef();
+  Impact.Key = Key;
+  Impact.Hit = Hit;
+  Impact.Sound = Sound;
+  Impact.SoundConcurrency = SoundConcurrency;
+  Impact.Particles = Particles;
+}
+
+FImpactMergeKey UImpactSignificanceSubsystem::GetMergeKey(AActor *Target, const FHitResult &Hit)
+{
+  FImpactMergeKey Key;
+
+  // Moving targets merge as a whole, static ones only around the hit so a wall isn't a single impact
+  if (Target && Target->IsRootComponentMovable())
+  {
+    Key.Object = Target;
+    return Key;
+  }
+
+  Key.Object = Hit.GetComponent();
+  const float CellSize = FMath::Max(CVarImpactMergeCellSize.GetValueOnGameThread(), 1.f);
+  Key.Cell = FIntVector(
+      FMath::FloorToInt32(Hit.Location.X / CellSize),
+      FMath::FloorToInt32(Hit.Location.Y / CellSize),
+      FMath::FloorToInt32(Hit.Location.Z / CellSize));
+  return Key;
+}
+
+void UImpactSignificanceSubsystem::FlushImpacts()
+{
+  const float Now = GetWorld()->GetTimeSeconds();
+  const float MergeWindow = CVarImpactMergeWindow.GetValueOnGameThread();
+
+  // Closed windows hand their merged hits back as one impact, scored with this frame's
+  for (auto It = MergeWindows.CreateIterator(); It; ++It)
+  {
+    if (It.Key().Object.IsStale())
+    {
+      It.RemoveCurrent();
+      continue;
+    }
+
+    if (Now - It.Value().StartTime > MergeWindow)
+    {
+      if (It.Value().Merged.MergedHits > 0)
+      {
+        PendingImpacts.Add(It.Value().Merged);
+      }
+      It.RemoveCurrent();
+    }
+  }
+
+  if (PendingImpacts.Num() == 0)
+    return;
+
+  APlayerCameraManager *CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+  if (!CameraManager)
+  {
+    PendingImpacts.Reset();
+    return;
+  }
+
+  const FVector CameraLocation = CameraManager->GetCameraLocation();
+  const FVector CameraForward = CameraManager->GetCameraRotation().Vector();
+  // Slightly wider than the view so hits on the edge of the screen still count
+  const float ScreenCos = FMath::Cos(FMath::DegreesToRadians(FMath::Min(CameraManager->GetFOVAngle() * 0.6f, 89.f)));
+  const float CullDistance = CVarImpactCullDistance.GetValueOnGameThread();
+
+  for (int32 i = PendingImpacts.Num() - 1; i >= 0; i--)
+  {
+    FImpactEvent &Impact = PendingImpacts[i];
+
+    // Target was hit recently, the hits add up until its window closes
+    if (FImpactMergeWindow *Window = MergeWindows.Find(Impact.Key))
+    {
+      const int32 MergedHits = Window->Merged.MergedHits + Impact.MergedHits;
+      Window->Merged = Impact;
+      Window->Merged.MergedHits = MergedHits;
+      PendingImpacts.RemoveAtSwap(i, 1, false);
+      continue;
+    }
+
+    const FVector ToImpact = Impact.Hit.Location - CameraLocation;
+    const float Distance = ToImpact.Size();
+    if (Distance > CullDistance)
+    {
+      PendingImpacts.RemoveAtSwap(i, 1, false);
+      continue;
+    }
+
+    Impact.bOnScreen = FVector::DotProduct(ToImpact.GetSafeNormal(), CameraForward) >= ScreenCos;
+
+    const float DistanceScore = 1.f - Distance / CullDistance;
+    const float ScreenScore = Impact.bOnScreen ? 1.f : 0.25f;
+    const float MergeScore = 1.f + 0.1f * (Impact.MergedHits - 1);
+    Impact.Significance = DistanceScore * ScreenScore * MergeScore;
+  }
+
+  PendingImpacts.Sort([](const FImpactEvent &A, const FImpactEvent &B)
+                      { return A.Significance > B.Significance; });
+
+  const int32 Budget = CVarImpactBudget.GetValueOnGameThread();
+  const int32 NumToPlay = Budget > 0 ? FMath::Min(Budget, PendingImpacts.Num()) : PendingImpacts.Num();
+  for (int32 i = 0; i < NumToPlay; i++)
+  {
+    PlayImpact(PendingImpacts[i]);
+
+    FImpactMergeWindow &Window = MergeWindows.Add(PendingImpacts[i].Key);
+    Window.StartTime = Now;
+    Window.Merged.MergedHits = 0;
+  }
+
+  PendingImpacts.Reset();
+}
+
+void UImpactSignificanceSubsystem::PlayImpact(const FImpactEvent &Impact)
+{
+  if (auto EnemyAudio = GetWorld()->GetSubsystem<UEnemyAudioSubsystem>())
+  {
+    EnemyAudio->PlayEnemySound(Impact.Sound.Get(), Impact.Hit.Location, Impact.SoundConcurrency.Get());
+  }
+
+  // Off screen hits are only heard
+  if (Impact.bOnScreen && Impact.Particles.IsValid())
+  {
+    UImpactFXSubsystem::SpawnBulletImpact(
+        this,
+        EImpactType::EIT_BulletImpact,
+        Impact.Hit,
+        static_cast<float>(Impact.MergedHits),
+        Impact.Particles.Get());
+  }
+}
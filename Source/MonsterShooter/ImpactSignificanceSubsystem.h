@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactSignificanceSubsystem.generated.h"
+
+class UParticleSystem;
+class USoundBase;
+class USoundConcurrency;
+
+/** What hits are merged by: the whole actor when it moves, an area of the surface hit when it is static */
+struct FImpactMergeKey
+{
+  TWeakObjectPtr<UObject> Object;
+
+  /** Cell of the hit on static surfaces, zero when the whole object merges */
+  FIntVector Cell = FIntVector::ZeroValue;
+
+  bool operator==(const FImpactMergeKey &Other) const { return Object == Other.Object && Cell == Other.Cell; }
+
+  friend uint32 GetTypeHash(const FImpactMergeKey &Key) { return HashCombine(GetTypeHash(Key.Object), GetTypeHash(Key.Cell)); }
+};
+
+/** Impact waiting for the end of the frame to be scored */
+struct FImpactEvent
+{
+  FImpactMergeKey Key;
+  FHitResult Hit;
+  TWeakObjectPtr<USoundBase> Sound;
+  TWeakObjectPtr<USoundConcurrency> SoundConcurrency;
+  TWeakObjectPtr<UParticleSystem> Particles;
+
+  /** Number of hits merged into this event */
+  int32 MergedHits = 1;
+
+  float Significance = 0.f;
+  bool bOnScreen = false;
+};
+
+/** Merge window of a target or surface area, opened when an impact on it plays */
+struct FImpactMergeWindow
+{
+  /** Time the impact opening the window played */
+  float StartTime = 0.f;
+
+  /** Hits received during the window, played as one impact when it closes. MergedHits is 0 while there are none */
+  FImpactEvent Merged;
+};
+
+/**
+ * Scores the impacts of a frame by distance to the camera, screen presence and how recently their target
+ * was already hit. Hits on the same target, or the same area of a static surface, in a short window are merged
+ * into one impact played when the window closes, with their summed intensity, far away hits are dropped,
+ * off screen hits only keep their sound, and only the most significant ones up to the frame budget play
+ */
+UCLASS()
+class MONSTERSHOOTER_API UImpactSignificanceSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Queues the effects of a hit on Target, null for world geometry, played at the end of the frame if significant enough */
+  void QueueImpact(
+      AActor *Target,
+      const FHitResult &Hit,
+      USoundBase *Sound,
+      UParticleSystem *Particles,
+      USoundConcurrency *SoundConcurrency = nullptr);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Key hits merge by, Target when it moves and the hit component and cell otherwise */
+  static FImpactMergeKey GetMergeKey(AActor *Target, const FHitResult &Hit);
+
+  /** Scores the queued impacts and plays the best ones within the budget */
+  void FlushImpacts();
+
+  /** Plays the sound and particles of an impact */
+  void PlayImpact(const FImpactEvent &Impact);
+
+  TArray<FImpactEvent> PendingImpacts;
+
+  /** Open merge window of each recently hit target or surface area */
+  TMap<FImpactMergeKey, FImpactMergeWindow> MergeWindows;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EImpactType : uint8
+{
+  EIT_BulletImpact UMETA(DisplayName = "BulletImpact"),
+  EIT_Blood UMETA(DisplayName = "Blood"),
+  EIT_MuzzleFlash UMETA(DisplayName = "MuzzleFlash"),
+
+  EIT_MAX UMETA(DisplayName = "DefaultMAX")
+};
@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Item.h"
+#include "MonsterShooter.h"
 #include "Components/BoxComponent.h"
 #include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
@@ -44,7 +45,7 @@ AItem::AItem() : ItemName(FString("Default")),
   CollisionBox = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisionBox"));
   CollisionBox->SetupAttachment(ItemMesh);
   CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-  CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+  CollisionBox->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Block);
 
   PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
   PickupWidget->SetupAttachment(GetRootComponent());
@@ -151,11 +152,13 @@ void AItem::SetItemProperties(EItemState State)
     ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
     // Set area sphere properties
     AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
+    AreaSphere->SetCollisionResponseToChannel(ECC_Weapon, ECollisionResponse::ECR_Ignore);
+    AreaSphere->SetCollisionResponseToChannel(ECC_Interact, ECollisionResponse::ECR_Ignore);
     AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-    // Set collision box properties
+    // Set collision box properties, only item traces can hit it
     CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
     CollisionBox->SetCollisionResponseToChannel(
-        ECollisionChannel::ECC_Visibility,
+        ECC_Interact,
         ECollisionResponse::ECR_Block);
     CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
     break;
@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LagCompensationSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "ShooterCharacter.h"
+
+static TAutoConsoleVariable<float> CVarMaxRewindTime(
+    TEXT("MonsterShooter.LagCompensation.MaxRewindTime"),
+    0.4f,
+    TEXT("How far back, in seconds, the server rewinds hitboxes to check a client shot."),
+    ECVF_Default);
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  if (!IsServer())
+  {
+    PendingShots.Reset();
+    return;
+  }
+
+  // The newest snapshot is the current pose, restoring after a rewind goes back to it
+  RecordSnapshot();
+  ResolveShots();
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+bool ULagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool ULagCompensationSubsystem::IsServer() const
+{
+  const ENetMode NetMode = GetWorld()->GetNetMode();
+  return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
+
+void ULagCompensationSubsystem::RegisterTarget(USkeletalMeshComponent *Mesh)
+{
+  if (!Mesh)
+    return;
+
+  FLagCompensationTarget &Target = Targets.AddDefaulted_GetRef();
+  Target.Mesh = Mesh;
+  Target.NumBodies = Mesh->Bodies.Num();
+  Target.BodyTransforms.SetNum(SnapshotCapacity * Target.NumBodies);
+
+  // No history yet, every snapshot starts at the current pose
+  for (int32 Body = 0; Body < Target.NumBodies; Body++)
+  {
+    const FBodyInstance *BodyInstance = Mesh->Bodies[Body];
+    const FTransform BodyTransform = BodyInstance ? BodyInstance->GetUnrealWorldTransform() : FTransform::Identity;
+    for (int32 Slot = 0; Slot < SnapshotCapacity; Slot++)
+    {
+      Target.BodyTransforms[Slot * Target.NumBodies + Body] = BodyTransform;
+    }
+  }
+}
+
+void ULagCompensationSubsystem::UnregisterTarget(USkeletalMeshComponent *Mesh)
+{
+  Targets.RemoveAllSwap([Mesh](const FLagCompensationTarget &Target)
+                        { return Target.Mesh.Get() == Mesh; });
+}
+
+void ULagCompensationSubsystem::QueueShot(AShooterCharacter *Shooter, const FVector &TraceStart, const FVector &TraceEnd, float FireTime)
+{
+  FRewindShot &Shot = PendingShots.AddDefaulted_GetRef();
+  Shot.Shooter = Shooter;
+  Shot.TraceStart = TraceStart;
+  Shot.TraceEnd = TraceEnd;
+  Shot.FireTime = FireTime;
+}
+
+void ULagCompensationSubsystem::RecordSnapshot()
+{
+  Targets.RemoveAllSwap([](const FLagCompensationTarget &Target)
+                        { return !Target.Mesh.IsValid(); });
+
+  NewestSnapshot = (NewestSnapshot + 1) % SnapshotCapacity;
+  NumSnapshots = FMath::Min(NumSnapshots + 1, SnapshotCapacity);
+  SnapshotTimes[NewestSnapshot] = GetWorld()->GetTimeSeconds();
+
+  for (FLagCompensationTarget &Target : Targets)
+  {
+    const USkeletalMeshComponent *Mesh = Target.Mesh.Get();
+    if (Mesh->Bodies.Num() != Target.NumBodies)
+      continue;
+
+    FTransform *Snapshot = &Target.BodyTransforms[NewestSnapshot * Target.NumBodies];
+    for (int32 Body = 0; Body < Target.NumBodies; Body++)
+    {
+      if (const FBodyInstance *BodyInstance = Mesh->Bodies[Body])
+      {
+        Snapshot[Body] = BodyInstance->GetUnrealWorldTransform();
+      }
+    }
+  }
+}
+
+void ULagCompensationSubsystem::ResolveShots()
+{
+  if (PendingShots.Num() == 0)
+    return;
+
+  const float Now = GetWorld()->GetTimeSeconds();
+  const float OldestFireTime = Now - CVarMaxRewindTime.GetValueOnGameThread();
+
+  // Shots grouped by the snapshot they are checked against
+  TMap<int32, TArray<int32, TInlineAllocator<16>>> ShotsBySnapshot;
+  for (int32 i = 0; i < PendingShots.Num(); i++)
+  {
+    const float FireTime = FMath::Clamp(PendingShots[i].FireTime, OldestFireTime, Now);
+    ShotsBySnapshot.FindOrAdd(FindSnapshot(FireTime)).Add(i);
+  }
+
+  for (const auto &Group : ShotsBySnapshot)
+  {
+    const bool bRewind = Group.Key != NewestSnapshot;
+    if (bRewind)
+    {
+      ApplySnapshot(Group.Key);
+    }
+
+    // Damage is queued, so nothing dies while the hitboxes are rewound
+    for (const int32 ShotIndex : Group.Value)
+    {
+      const FRewindShot &Shot = PendingShots[ShotIndex];
+      if (AShooterCharacter *Shooter = Shot.Shooter.Get())
+      {
+        Shooter->ResolveRewoundShot(Shot.TraceStart, Shot.TraceEnd);
+      }
+    }
+
+    if (bRewind)
+    {
+      ApplySnapshot(NewestSnapshot);
+    }
+  }
+
+  PendingShots.Reset();
+}
+
+int32 ULagCompensationSubsystem::FindSnapshot(float Time) const
+{
+  int32 Slot = NewestSnapshot;
+  for (int32 Age = 0; Age < NumSnapshots; Age++)
+  {
+    Slot = (NewestSnapshot - Age + SnapshotCapacity) % SnapshotCapacity;
+    if (SnapshotTimes[Slot] <= Time)
+      return Slot;
+  }
+
+  // Older than the whole history, use the oldest snapshot
+  return Slot;
+}
+
+void ULagCompensationSubsystem::ApplySnapshot(int32 Slot)
+{
+  for (const FLagCompensationTarget &Target : Targets)
+  {
+    USkeletalMeshComponent *Mesh = Target.Mesh.Get();
+    if (!Mesh || Mesh->Bodies.Num() != Target.NumBodies)
+      continue;
+
+    const FTransform *Snapshot = &Target.BodyTransforms[Slot * Target.NumBodies];
+    for (int32 Body = 0; Body < Target.NumBodies; Body++)
+    {
+      if (FBodyInstance *BodyInstance = Mesh->Bodies[Body])
+      {
+        BodyInstance->SetBodyTransform(Snapshot[Body], ETeleportType::TeleportPhysics);
+      }
+    }
+  }
+}
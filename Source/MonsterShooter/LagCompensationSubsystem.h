@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LagCompensationSubsystem.generated.h"
+
+/** Hitbox history of one skeletal mesh */
+struct FLagCompensationTarget
+{
+  TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+  /** Number of physics bodies recorded per snapshot */
+  int32 NumBodies = 0;
+
+  /** World transform of every body, SnapshotCapacity snapshots of NumBodies each */
+  TArray<FTransform> BodyTransforms;
+};
+
+/** Client shot waiting to be checked on the server */
+struct FRewindShot
+{
+  TWeakObjectPtr<class AShooterCharacter> Shooter;
+  FVector TraceStart;
+  FVector TraceEnd;
+
+  /** Server time the client fired at */
+  float FireTime;
+};
+
+/**
+ * Server side lag compensation. Records the hitbox transforms of the registered meshes every frame
+ * into a ring buffer, and checks client shots against the snapshot matching their fire time.
+ * Shots are grouped by snapshot so the world is rewound once per snapshot, not once per shot
+ */
+UCLASS()
+class MONSTERSHOOTER_API ULagCompensationSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Starts recording the hitboxes of Mesh */
+  void RegisterTarget(USkeletalMeshComponent *Mesh);
+
+  void UnregisterTarget(USkeletalMeshComponent *Mesh);
+
+  /** Queues a client shot, checked against the rewound hitboxes on the next tick */
+  void QueueShot(AShooterCharacter *Shooter, const FVector &TraceStart, const FVector &TraceEnd, float FireTime);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** If this world checks shots from remote clients */
+  bool IsServer() const;
+
+  /** Stores the current hitbox transforms as the newest snapshot */
+  void RecordSnapshot();
+
+  /** Checks the queued shots, rewinding once per snapshot they need */
+  void ResolveShots();
+
+  /** Ring buffer slot of the newest snapshot taken at or before Time */
+  int32 FindSnapshot(float Time) const;
+
+  /** Moves every registered hitbox to the transforms of a snapshot */
+  void ApplySnapshot(int32 Slot);
+
+  /** Number of snapshots kept in the ring buffer */
+  static constexpr int32 SnapshotCapacity = 64;
+
+  TArray<FLagCompensationTarget> Targets;
+
+  /** Time of each snapshot slot */
+  float SnapshotTimes[SnapshotCapacity];
+
+  /** Slot of the newest snapshot */
+  int32 NewestSnapshot = INDEX_NONE;
+
+  /** Number of valid snapshots in the ring buffer */
+  int32 NumSnapshots = 0;
+
+  TArray<FRewindShot> PendingShots;
+};
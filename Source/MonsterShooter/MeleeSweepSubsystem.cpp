@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MeleeSweepSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Enemy.h"
+
+static TAutoConsoleVariable<int32> CVarMeleeSubsteps(
+    TEXT("MonsterShooter.AI.MeleeSubsteps"),
+    4,
+    TEXT("Number of sphere sweeps the weapon path of a melee swing is split in each frame."),
+    ECVF_Default);
+
+/** Location of Bone in the space of Mesh */
+static FVector GetBoneComponentLocation(const USkeletalMeshComponent *Mesh, FName Bone)
+{
+  return Mesh->GetSocketTransform(Bone, RTS_Component).GetLocation();
+}
+
+void UMeleeSweepSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  if (Swings.Num() == 0)
+    return;
+
+  ResolveSweeps();
+  RequestSweeps();
+}
+
+TStatId UMeleeSweepSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UMeleeSweepSubsystem, STATGROUP_Tickables);
+}
+
+bool UMeleeSweepSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMeleeSweepSubsystem::BeginSwing(AEnemy *Enemy, FName Bone, float Radius)
+{
+  EndSwing(Enemy, Bone);
+
+  const USkeletalMeshComponent *Mesh = Enemy->GetMesh();
+  FMeleeSwing &Swing = Swings.AddDefaulted_GetRef();
+  Swing.Enemy = Enemy;
+  Swing.Bone = Bone;
+  Swing.Radius = Radius;
+  Swing.PreviousMeshTransform = Mesh->GetComponentTransform();
+  Swing.PreviousBoneLocation = GetBoneComponentLocation(Mesh, Bone);
+}
+
+void UMeleeSweepSubsystem::EndSwing(AEnemy *Enemy, FName Bone)
+{
+  for (FMeleeSwing &Swing : Swings)
+  {
+    if (Swing.Enemy.Get() == Enemy && Swing.Bone == Bone && !Swing.bEnded)
+    {
+      // The tick may come after the animation moved on, the final sweep stops where the window closed
+      const USkeletalMeshComponent *Mesh = Enemy->GetMesh();
+      Swing.bEnded = true;
+      Swing.EndMeshTransform = Mesh->GetComponentTransform();
+      Swing.EndBoneLocation = GetBoneComponentLocation(Mesh, Bone);
+    }
+  }
+}
+
+void UMeleeSweepSubsystem::ResolveSweeps()
+{
+  UWorld *World = GetWorld();
+  const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+  FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeSweep), false);
+
+  for (FMeleeSwing &Swing : Swings)
+  {
+    AEnemy *Enemy = Swing.Enemy.Get();
+    if (!Enemy || Enemy->IsDead())
+    {
+      Swing.Sweeps.Reset();
+      continue;
+    }
+
+    QueryParams.ClearIgnoredActors();
+    QueryParams.AddIgnoredActor(Enemy);
+
+    for (const FMeleeSweepSegment &Sweep : Swing.Sweeps)
+    {
+      FTraceDatum SweepData;
+      if (!World->QueryTraceData(Sweep.Handle, SweepData))
+      {
+        // Results missing or expired after a hitch, the segment is swept now so the hit isn't lost
+        World->SweepMultiByObjectType(
+            SweepData.OutHits,
+            Sweep.Start,
+            Sweep.End,
+            FQuat::Identity,
+            ObjectParams,
+            FCollisionShape::MakeSphere(Swing.Radius),
+            QueryParams);
+      }
+
+      for (const FHitResult &Hit : SweepData.OutHits)
+      {
+        AActor *HitActor = Hit.GetActor();
+        if (!HitActor || Swing.HitActors.Contains(HitActor))
+          continue;
+
+        Swing.HitActors.Add(HitActor);
+        Enemy->DoDamage(HitActor, Hit);
+      }
+    }
+
+    Swing.Sweeps.Reset();
+  }
+
+  Swings.RemoveAllSwap([](const FMeleeSwing &Swing)
+                       { return Swing.bFinalSweepRequested || !Swing.Enemy.IsValid() || Swing.Enemy->IsDead(); },
+                       false);
+}
+
+void UMeleeSweepSubsystem::RequestSweeps()
+{
+  UWorld *World = GetWorld();
+  const int32 Substeps = FMath::Max(CVarMeleeSubsteps.GetValueOnGameThread(), 1);
+  const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+  FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeSweep), false);
+
+  for (FMeleeSwing &Swing : Swings)
+  {
+    AEnemy *Enemy = Swing.Enemy.Get();
+    const USkeletalMeshComponent *Mesh = Enemy->GetMesh();
+    const FTransform MeshTransform = Swing.bEnded ? Swing.EndMeshTransform : Mesh->GetComponentTransform();
+    const FVector BoneLocation = Swing.bEnded ? Swing.EndBoneLocation : GetBoneComponentLocation(Mesh, Swing.Bone);
+
+    QueryParams.ClearIgnoredActors();
+    QueryParams.AddIgnoredActor(Enemy);
+    const FCollisionShape Sphere = FCollisionShape::MakeSphere(Swing.Radius);
+
+    FVector SubstepStart = Swing.PreviousMeshTransform.TransformPosition(Swing.PreviousBoneLocation);
+    for (int32 Step = 1; Step <= Substeps; Step++)
+    {
+      // Bone and mesh interpolated apart, an enemy turning during the swing curves the path
+      const float Alpha = static_cast<float>(Step) / Substeps;
+      FTransform SubstepMeshTransform;
+      SubstepMeshTransform.Blend(Swing.PreviousMeshTransform, MeshTransform, Alpha);
+      const FVector SubstepEnd = SubstepMeshTransform.TransformPosition(FMath::Lerp(Swing.PreviousBoneLocation, BoneLocation, Alpha));
+
+      FMeleeSweepSegment &Sweep = Swing.Sweeps.AddDefaulted_GetRef();
+      Sweep.Start = SubstepStart;
+      Sweep.End = SubstepEnd;
+      Sweep.Handle = World->AsyncSweepByObjectType(
+          EAsyncTraceType::Multi,
+          SubstepStart,
+          SubstepEnd,
+          FQuat::Identity,
+          ObjectParams,
+          Sphere,
+          QueryParams);
+
+      SubstepStart = SubstepEnd;
+    }
+
+    Swing.PreviousMeshTransform = MeshTransform;
+    Swing.PreviousBoneLocation = BoneLocation;
+    Swing.bFinalSweepRequested = Swing.bEnded;
+  }
+}
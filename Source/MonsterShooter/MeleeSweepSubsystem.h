@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "MeleeSweepSubsystem.generated.h"
+
+class AEnemy;
+
+/** Substep sweep of a swing, with its segment to sweep again if the async result is missing */
+struct FMeleeSweepSegment
+{
+  FTraceHandle Handle;
+  FVector Start;
+  FVector End;
+};
+
+/** Active window of one weapon bone during a melee attack */
+struct FMeleeSwing
+{
+  TWeakObjectPtr<AEnemy> Enemy;
+  FName Bone;
+  float Radius = 0.f;
+
+  /** Bone location in mesh space and mesh transform at the last sample */
+  FVector PreviousBoneLocation;
+  FTransform PreviousMeshTransform;
+
+  /** Actors already hit by this swing, each one is hit once */
+  TArray<TWeakObjectPtr<AActor>, TInlineAllocator<2>> HitActors;
+
+  /** Sweeps requested last tick, resolved this tick */
+  TArray<FMeleeSweepSegment, TInlineAllocator<8>> Sweeps;
+
+  /** Window closed, the swing sweeps up to the end pose once more and is removed once those sweeps are resolved */
+  bool bEnded = false;
+  bool bFinalSweepRequested = false;
+
+  /** Bone location in mesh space and mesh transform when the window closed */
+  FVector EndBoneLocation;
+  FTransform EndMeshTransform;
+};
+
+/**
+ * Melee hit detection for enemy attacks. While a swing is active the path of its weapon bone since the last
+ * frame is split in fixed substeps, interpolated in mesh space so turning while swinging still curves the path,
+ * and every substep of every swing is swept together as async sphere sweeps resolved on the next tick.
+ * A closed swing is swept one last time up to the pose it closed at, so swings shorter than a frame still hit.
+ * A swing hits each actor at most once
+ */
+UCLASS()
+class MONSTERSHOOTER_API UMeleeSweepSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Starts sweeping Bone of Enemy with a sphere of Radius */
+  void BeginSwing(AEnemy *Enemy, FName Bone, float Radius);
+
+  /** Stops sweeping Bone of Enemy once its path up to the current pose is swept */
+  void EndSwing(AEnemy *Enemy, FName Bone);
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Damages the actors found by last tick's sweeps */
+  void ResolveSweeps();
+
+  /** Requests the substep sweeps of every active swing */
+  void RequestSweeps();
+
+  TArray<FMeleeSwing> Swings;
+};
@@ -4,3 +4,8 @@
 
 #include "CoreMinimal.h"
 
+// Project trace channels, declared in [/Script/Engine.CollisionProfile] of DefaultEngine.ini
+#define ECC_Weapon ECollisionChannel::ECC_GameTraceChannel1
+#define ECC_Interact ECollisionChannel::ECC_GameTraceChannel2
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMonsterShooter, Log, All);
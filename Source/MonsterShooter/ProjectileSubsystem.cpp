@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundCue.h"
+#include "MonsterShooter.h"
+#include "BulletHitInterface.h"
+#include "DamageQueueSubsystem.h"
+#include "TraceBudgetSubsystem.h"
+#include "FXPoolSubsystem.h"
+#include "Enemy.h"
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  if (Positions.Num() == 0)
+    return;
+
+  ResolveSweeps();
+  Integrate(DeltaTime);
+  RequestSweeps();
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileSubsystem::Deinitialize()
+{
+  for (const FProjectilePayload &Payload : Payloads)
+  {
+    if (Payload.Trail.IsValid())
+    {
+      Payload.Trail->DestroyComponent();
+    }
+  }
+
+  Super::Deinitialize();
+}
+
+bool UProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UProjectileSubsystem::LaunchProjectile(
+    const FVector &Location,
+    const FVector &Direction,
+    const FProjectileProperties &Properties,
+    float DirectDamage,
+    AActor *DamageCauser,
+    AController *InstigatorController,
+    AActor *Shooter)
+{
+  Positions.Add(Location);
+  PreviousPositions.Add(Location);
+  Velocities.Add(Direction.GetSafeNormal() * Properties.Speed);
+  GravityZs.Add(GetWorld()->GetGravityZ() * Properties.GravityScale);
+  Drags.Add(Properties.Drag);
+  Ages.Add(0.f);
+  Lifetimes.Add(Properties.Lifetime);
+  SweepHandles.Add(FTraceHandle());
+
+  FProjectilePayload &Payload = Payloads.AddDefaulted_GetRef();
+  Payload.Properties = Properties;
+  Payload.DirectDamage = DirectDamage;
+  Payload.DamageCauser = DamageCauser;
+  Payload.InstigatorController = InstigatorController;
+  Payload.Shooter = Shooter;
+
+  if (Properties.TrailParticles)
+  {
+    Payload.Trail = UGameplayStatics::SpawnEmitterAtLocation(
+        GetWorld(),
+        Properties.TrailParticles,
+        Location,
+        Direction.Rotation());
+  }
+}
+
+void UProjectileSubsystem::ResolveSweeps()
+{
+  UWorld *World = GetWorld();
+
+  // Backwards, detonated projectiles are swapped with the last one
+  for (int32 i = Positions.Num() - 1; i >= 0; i--)
+  {
+    // Projectiles launched since the last tick have nothing to resolve yet
+    if (!SweepHandles[i].IsValid())
+      continue;
+
+    FHitResult SyncHit;
+    const FHitResult *Hit = nullptr;
+    FTraceDatum SweepData;
+    if (World->QueryTraceData(SweepHandles[i], SweepData))
+    {
+      Hit = FHitResult::GetFirstBlockingHit(SweepData.OutHits);
+    }
+    else
+    {
+      // Results missing or expired after a hitch, the segment is swept now so the projectile can't tunnel through it
+      FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileTrace), false);
+      QueryParams.AddIgnoredActor(Payloads[i].Shooter.Get());
+      if (World->LineTraceSingleByChannel(SyncHit, PreviousPositions[i], Positions[i], ECC_Weapon, QueryParams))
+      {
+        Hit = &SyncHit;
+      }
+
+      if (auto TraceBudget = World->GetSubsystem<UTraceBudgetSubsystem>())
+      {
+        TraceBudget->RecordTraces(1);
+      }
+    }
+
+    if (Hit)
+    {
+      Detonate(i, *Hit);
+      RemoveProjectile(i);
+    }
+  }
+}
+
+void UProjectileSubsystem::Integrate(float DeltaTime)
+{
+  const int32 NumProjectiles = Positions.Num();
+  for (int32 i = 0; i < NumProjectiles; i++)
+  {
+    Velocities[i].Z += GravityZs[i] * DeltaTime;
+    Velocities[i] *= FMath::Max(0.f, 1.f - Drags[i] * DeltaTime);
+
+    PreviousPositions[i] = Positions[i];
+    Positions[i] += Velocities[i] * DeltaTime;
+    Ages[i] += DeltaTime;
+  }
+
+  // Projectiles out of time detonate where they are
+  for (int32 i = NumProjectiles - 1; i >= 0; i--)
+  {
+    if (Ages[i] >= Lifetimes[i])
+    {
+      FHitResult FuseHit(nullptr, nullptr, Positions[i], -Velocities[i].GetSafeNormal());
+      Detonate(i, FuseHit);
+      RemoveProjectile(i);
+    }
+  }
+}
+
+void UProjectileSubsystem::RequestSweeps()
+{
+  UWorld *World = GetWorld();
+  FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileTrace), false);
+
+  const int32 NumProjectiles = Positions.Num();
+  for (int32 i = 0; i < NumProjectiles; i++)
+  {
+    QueryParams.ClearIgnoredActors();
+    QueryParams.AddIgnoredActor(Payloads[i].Shooter.Get());
+
+    SweepHandles[i] = World->AsyncLineTraceByChannel(
+        EAsyncTraceType::Single,
+        PreviousPositions[i],
+        Positions[i],
+        ECC_Weapon,
+        QueryParams);
+
+    if (Payloads[i].Trail.IsValid())
+    {
+      Payloads[i].Trail->SetWorldLocationAndRotation(Positions[i], Velocities[i].Rotation());
+    }
+  }
+
+  if (auto TraceBudget = World->GetSubsystem<UTraceBudgetSubsystem>())
+  {
+    TraceBudget->RecordTraces(NumProjectiles);
+  }
+}
+
+void UProjectileSubsystem::Detonate(int32 Index, const FHitResult &Hit)
+{
+  const FProjectilePayload &Payload = Payloads[Index];
+  const FProjectileProperties &Properties = Payload.Properties;
+  AActor *DamageCauser = Payload.DamageCauser.Get();
+  AController *InstigatorController = Payload.InstigatorController.Get();
+  // Clients only simulate projectiles for their effects, the server's copy deals the damage
+  auto DamageQueue = GetWorld()->IsNetMode(NM_Client) ? nullptr : GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+
+  AActor *HitActor = Hit.GetActor();
+  if (HitActor)
+  {
+    IBulletHitInterface *BulletHitInterface = Cast<IBulletHitInterface>(HitActor);
+    if (BulletHitInterface)
+    {
+      BulletHitInterface->BulletHit_Implementation(Hit, Payload.Shooter.Get(), InstigatorController);
+    }
+
+    AEnemy *HitEnemy = Cast<AEnemy>(HitActor);
+    if (DamageQueue && HitEnemy && !HitEnemy->IsDead())
+    {
+      DamageQueue->QueueBulletDamage(
+          HitEnemy,
+          Payload.DirectDamage,
+          0.f,
+          Hit.Location,
+          false,
+          InstigatorController,
+          DamageCauser);
+    }
+  }
+
+  if (DamageQueue && Properties.ExplosionRadius > 0.f)
+  {
+    DamageQueue->QueueRadialDamage(
+        Properties.ExplosionDamage,
+        Properties.ExplosionDamage * 0.1f,
+        Hit.Location,
+        Properties.ExplosionRadius * 0.3f,
+        Properties.ExplosionRadius,
+        1.f,
+        DamageCauser,
+        InstigatorController);
+  }
+
+  if (Properties.ExplosionParticles)
+  {
+    UFXPoolSubsystem::SpawnPooledEmitter(this, Properties.ExplosionParticles, FTransform(Hit.Location));
+  }
+
+  if (Properties.ExplosionSound)
+  {
+    UGameplayStatics::PlaySoundAtLocation(this, Properties.ExplosionSound, Hit.Location);
+  }
+
+  if (Payload.Trail.IsValid())
+  {
+    // Let the trail fade out, it destroys itself once finished
+    Payload.Trail->Deactivate();
+  }
+}
+
+void UProjectileSubsystem::RemoveProjectile(int32 Index)
+{
+  Positions.RemoveAtSwap(Index, 1, false);
+  PreviousPositions.RemoveAtSwap(Index, 1, false);
+  Velocities.RemoveAtSwap(Index, 1, false);
+  GravityZs.RemoveAtSwap(Index, 1, false);
+  Drags.RemoveAtSwap(Index, 1, false);
+  Ages.RemoveAtSwap(Index, 1, false);
+  Lifetimes.RemoveAtSwap(Index, 1, false);
+  SweepHandles.RemoveAtSwap(Index, 1, false);
+  Payloads.RemoveAtSwap(Index, 1, false);
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "Weapon.h"
+#include "ProjectileSubsystem.generated.h"
+
+/** Data of a projectile only needed when it detonates */
+USTRUCT()
+struct FProjectilePayload
+{
+  GENERATED_BODY()
+
+  UPROPERTY()
+  FProjectileProperties Properties;
+
+  /** Damage dealt to the actor hit directly */
+  float DirectDamage = 0.f;
+
+  TWeakObjectPtr<AActor> DamageCauser;
+  TWeakObjectPtr<AController> InstigatorController;
+
+  /** Actor that fired the projectile, it never collides with it */
+  TWeakObjectPtr<AActor> Shooter;
+
+  TWeakObjectPtr<class UParticleSystemComponent> Trail;
+};
+
+/**
+ * Simulates every projectile in the world without spawning actors. State is kept in flat arrays,
+ * integrated together each tick and swept with async traces whose hits are resolved on the next tick
+ */
+UCLASS()
+class MONSTERSHOOTER_API UProjectileSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+  virtual void Deinitialize() override;
+
+  /** Starts simulating a projectile from Location, flying in Direction */
+  void LaunchProjectile(
+      const FVector &Location,
+      const FVector &Direction,
+      const FProjectileProperties &Properties,
+      float DirectDamage,
+      AActor *DamageCauser,
+      AController *InstigatorController,
+      AActor *Shooter);
+
+  FORCEINLINE int32 GetNumProjectiles() const { return Positions.Num(); }
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Applies the hits of the sweeps requested last tick */
+  void ResolveSweeps();
+
+  /** Moves every projectile with gravity and drag */
+  void Integrate(float DeltaTime);
+
+  /** Requests the sweep of the segment each projectile travelled this tick */
+  void RequestSweeps();
+
+  /** Hit effects, direct damage and explosion of a projectile */
+  void Detonate(int32 Index, const FHitResult &Hit);
+
+  /** Removes a projectile by swapping the last one in its place */
+  void RemoveProjectile(int32 Index);
+
+  // Projectile state, one entry per projectile at the same index in every array
+  TArray<FVector> Positions;
+  TArray<FVector> PreviousPositions;
+  TArray<FVector> Velocities;
+  TArray<float> GravityZs;
+  TArray<float> Drags;
+  TArray<float> Ages;
+  TArray<float> Lifetimes;
+  TArray<FTraceHandle> SweepHandles;
+
+  UPROPERTY()
+  TArray<FProjectilePayload> Payloads;
+};
@@ -10,6 +10,7 @@
 #include "EnhancedInputComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
+#include "Components/AudioComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "DrawDebugHelpers.h"
 #include "Particles/ParticleSystemComponent.h"
@@ -24,6 +25,20 @@
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "HealthComponent.h"
+#include "ViewRayComponent.h"
+#include "MonsterShooter.h"
+#include "DamageQueueSubsystem.h"
+#include "TraceBudgetSubsystem.h"
+#include "ProjectileSubsystem.h"
+#include "LagCompensationSubsystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "FXPoolSubsystem.h"
+#include "ImpactFXSubsystem.h"
+#include "TracerSubsystem.h"
+#include "DecalSubsystem.h"
+#include "SurfaceImpactSubsystem.h"
+#include "ImpactSignificanceSubsystem.h"
 
 // Sets default values
 AShooterCharacter::AShooterCharacter() : bAiming(false),
@@ -47,9 +62,20 @@ AShooterCharacter::AShooterCharacter() : bAiming(false),
                                          bFiringBullet(false),
                                          // Automatic fire variables
                                          bFireButtonPressed(false),
-                                         bShouldFire(true),
+                                         FireTimeAccumulator(0.f),
+                                         FireStartFrame(0),
+                                         bAsyncHitscan(true),
+                                         MaxClientShotOffset(1'000.f),
+                                         MaxClientRoundsPerSubmit(4),
+                                         ClientInterpolationDelay(0.1f), // CharacterMovement's simulated smoothing time
+                                         ClientShotAllowance(0.f),
+                                         LastClientShotTime(0.f),
+                                         MaxWallThickness(30.f),
+                                         // Bullet impact variables
+                                         BulletHoleSize(5.f),
                                          // Item trace variables
                                          bShouldTraceForItems(false),
+                                         ItemTraceRange(1'500.f),
                                          OverlappedItemCount(0),
                                          // Camera interp location variables
                                          CameraInterpDistance(150.f),
@@ -57,6 +83,7 @@ AShooterCharacter::AShooterCharacter() : bAiming(false),
                                          // Ammo variables
                                          Starting9mmAmmo(85),
                                          StartingARAmmo(150),
+                                         StartingGrenadeAmmo(12),
                                          // Combat variables
                                          CombatState(ECombatState::ECS_Unoccupied),
                                          bCrouching(false),
@@ -97,6 +124,14 @@ AShooterCharacter::AShooterCharacter() : bAiming(false),
   FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach camera to end of boom
   FollowCamera->bUsePawnControlRotation = false;                              // Camera does not rotate relative to arm
 
+  // Create the crosshair view ray cache
+  ViewRay = CreateDefaultSubobject<UViewRayComponent>(TEXT("ViewRay"));
+
+  FireAudioComponent = CreateDefaultSubobject<UAudioComponent>(TEXT("FireAudio"));
+  FireAudioComponent->SetupAttachment(RootComponent);
+  FireAudioComponent->bAutoActivate = false;
+  FireAudioComponent->bAllowSpatialization = false;
+
   HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
   HealthComponent->MaxHealth = 100.f;
   HealthComponent->HealthRegen = 0.5f,
@@ -150,11 +185,15 @@ float AShooterCharacter::TakeDamage(
     Die();
 
     auto EnemyController = Cast<AEnemyController>(EventInstigator);
-    if (EnemyController && EnemyController->GetBlackboardComponent())
+    if (EnemyController)
+    {
+      EnemyController->GetEnemyBlackboard().SetCharacterIsDead(true);
+    }
+
+    auto Enemy = Cast<AEnemy>(DamageCauser);
+    if (Enemy)
     {
-      EnemyController->GetBlackboardComponent()->SetValueAsBool(
-          FName(TEXT("CharacterIsDead")),
-          true);
+      Enemy->OnTargetKilled();
     }
   }
 
@@ -187,6 +226,12 @@ void AShooterCharacter::BeginPlay()
 
   GetCharacterMovement()->MaxWalkSpeed = BaseMovementSpeed;
 
+  if (auto FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>())
+  {
+    FXPool->Prewarm(ImpactParticles, 16);
+    FXPool->Prewarm(BloodParticles, 4);
+  }
+
   // Spawn the default weapon and equip it
   EquipWeapon(SpawnDefaultWeapon());
   Inventory.Add(EquippedWeapon);
@@ -487,34 +532,56 @@ void AShooterCharacter::FireWeapon()
     return;
   }
 
+  FireRounds(1);
+
+  // Start counting towards the next round
+  CombatState = ECombatState::ECS_FireTimerInProgress;
+  FireTimeAccumulator = 0.f;
+  FireStartFrame = GFrameCounter;
+}
+
+void AShooterCharacter::FireRounds(int32 Count)
+{
+  if (Count <= 0)
+    return;
+
   PlayFireSound();
-  SendBullet();
+  SendBullet(Count);
   PlayGunFireMontage();
   TriggerRecoil();
   StartCrosshairBulletFire();
-  EquippedWeapon->ConsumeAmmo();
-
-  StartFireTimer();
+  EquippedWeapon->ConsumeAmmo(Count);
 }
 
 bool AShooterCharacter::GetBeamEndLocation(
     const FVector &MuzzleSocketLocation,
     FHitResult &OutHitResult)
 {
-  FVector OutBeamLocation;
+  if (auto TraceBudget = GetWorld()->GetSubsystem<UTraceBudgetSubsystem>())
+  {
+    // Crosshair and barrel traces
+    TraceBudget->RecordTraces(2);
+  }
+
+  FVector CrosshairTraceStart;
+  FVector CrosshairTraceEnd;
+  if (!GetCrosshairTrace(CrosshairTraceStart, CrosshairTraceEnd, true))
+    return false;
+
+  RecordClientShot(CrosshairTraceStart, CrosshairTraceEnd);
+
   // Check for crosshair trace hit
   FHitResult CrosshairHitResult;
-  bool bCrosshairHit = TraceUnderCrosshair(CrosshairHitResult, OutBeamLocation, true);
+  GetWorld()->LineTraceSingleByChannel(
+      CrosshairHitResult,
+      CrosshairTraceStart,
+      CrosshairTraceEnd,
+      ECC_Weapon,
+      GetBulletQueryParams());
 
-  if (bCrosshairHit)
-  {
-    // Tentative beam location - still need to trace from gun
-    OutBeamLocation = CrosshairHitResult.Location;
-  }
-  else // no crosshair trace hit
-  {
-    // OutBeamLocation is the End location for the line trace
-  }
+  // Tentative beam location - still need to trace from gun
+  // Without a crosshair hit, the end of the crosshair ray is the end location for the line trace
+  FVector OutBeamLocation{CrosshairHitResult.bBlockingHit ? CrosshairHitResult.Location : CrosshairTraceEnd};
 
   // Perform trace from gun barrel
   const FVector WeaponTraceStart{MuzzleSocketLocation};
@@ -524,7 +591,8 @@ bool AShooterCharacter::GetBeamEndLocation(
       OutHitResult,
       WeaponTraceStart,
       WeaponTraceEnd,
-      ECollisionChannel::ECC_Visibility);
+      ECC_Weapon,
+      GetBulletQueryParams());
 
   if (!OutHitResult.bBlockingHit) // object between barrel and BeamEndPoint?
   {
@@ -535,40 +603,43 @@ bool AShooterCharacter::GetBeamEndLocation(
   return true;
 }
 
-void AShooterCharacter::StartFireTimer()
+void AShooterCharacter::UpdateFireScheduler(float DeltaTime)
 {
-  if (!EquippedWeapon)
-    return;
-  CombatState = ECombatState::ECS_FireTimerInProgress;
-
-  GetWorldTimerManager().SetTimer(
-      AutoFireTimer,
-      this,
-      &AShooterCharacter::AutoFireReset,
-      EquippedWeapon->GetFireRate());
-}
-
-void AShooterCharacter::AutoFireReset()
-{
-  if (CombatState == ECombatState::ECS_FireTimerInProgress)
+  if (!EquippedWeapon || CombatState != ECombatState::ECS_FireTimerInProgress)
   {
-    CombatState = ECombatState::ECS_Unoccupied;
+    // Stopped firing for any reason, reload, weapon swap or death
+    StopFireLoop();
+    return;
   }
 
-  if (!EquippedWeapon || CombatState != ECombatState::ECS_Unoccupied)
+  // The frame of the first round already elapsed before it was fired
+  if (FireStartFrame == GFrameCounter)
+    return;
+
+  FireTimeAccumulator += DeltaTime;
+  if (FireTimeAccumulator < EquippedWeapon->GetFireRate())
     return;
 
-  if (WeaponHasAmmo())
+  if (!WeaponHasAmmo())
   {
-    if (bFireButtonPressed && EquippedWeapon->GetAutomatic())
-    {
-      FireWeapon();
-    }
+    CombatState = ECombatState::ECS_Unoccupied;
+    FireTimeAccumulator = 0.f;
+    ReloadWeapon();
+    return;
   }
-  else
+
+  if (bFireButtonPressed && EquippedWeapon->GetAutomatic())
   {
-    ReloadWeapon();
+    // Every round that became due since last frame is fired in one batch
+    const int32 RoundsDue = EquippedWeapon->ConsumeFireTime(FireTimeAccumulator);
+    FireRounds(FMath::Min(RoundsDue, EquippedWeapon->GetAmmo()));
+    return;
   }
+
+  // Trigger released or semi-automatic weapon, ready to fire again
+  CombatState = ECombatState::ECS_Unoccupied;
+  FireTimeAccumulator = 0.f;
+  StopFireLoop();
 }
 
 // OLD WAY !! //
@@ -736,55 +807,19 @@ void AShooterCharacter::FinishCrosshairBulletFire()
 
 bool AShooterCharacter::TraceUnderCrosshair(FHitResult &OutHitResult, FVector &OutHitLocation, bool bShooting)
 {
-  // Get Viewport size
-  FVector2D ViewportSize;
-  if (GEngine && GEngine->GameViewport)
-  {
-    GEngine->GameViewport->GetViewportSize(ViewportSize);
-  }
+  FVector Start;
+  FVector End;
 
-  // Get screen space location of crosshair
-  FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-  FVector CrosshairWorldPosition;
-  FVector CrosshairWorldDirection;
-  FVector2D WeaponAccuracySpread;
-  FVector2D FinalLocation = CrosshairLocation;
-  if (bShooting)
+  if (GetCrosshairTrace(Start, End, bShooting))
   {
-    float const BulletSpreadFactor = (100.0f - EquippedWeapon->GetAccuracy()) / 100.0f;
-
-    if (bAiming)
-    {
-      WeaponAccuracySpread = FMath::RandPointInCircle(
-          80.f * (BulletSpreadFactor));
-    }
-    else
-    {
-      WeaponAccuracySpread = FMath::RandPointInCircle(
-          80.f * BulletSpreadFactor *
-          2.0f);
-    }
-    FinalLocation = CrosshairLocation + WeaponAccuracySpread;
-  }
-
-  // Get world position and direction of crosshair
-  bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
-      UGameplayStatics::GetPlayerController(this, 0),
-      FinalLocation,
-      CrosshairWorldPosition,
-      CrosshairWorldDirection);
-
-  if (bScreenToWorld)
-  {
-    // Trace from Crosshair world location outward
-    const FVector Start{CrosshairWorldPosition};
-    const FVector End{Start + CrosshairWorldDirection * 50'000.f};
+    // Trace from Crosshair world location outward, shots on the weapon channel and item focus on the interact one
     OutHitLocation = End;
     GetWorld()->LineTraceSingleByChannel(
         OutHitResult,
         Start,
         End,
-        ECollisionChannel::ECC_Visibility);
+        bShooting ? ECC_Weapon : ECC_Interact,
+        bShooting ? GetBulletQueryParams() : FCollisionQueryParams::DefaultQueryParam);
 
     if (OutHitResult.bBlockingHit)
     {
@@ -796,6 +831,40 @@ bool AShooterCharacter::TraceUnderCrosshair(FHitResult &OutHitResult, FVector &O
   return false;
 }
 
+bool AShooterCharacter::GetCrosshairTrace(FVector &OutStart, FVector &OutEnd, bool bShooting)
+{
+  if (!ViewRay || !ViewRay->HasValidRay())
+    return false;
+
+  FVector Direction = ViewRay->GetRayDirection();
+  if (bShooting)
+  {
+    const FVector2D WeaponAccuracySpread = FMath::RandPointInCircle(GetBulletSpreadRadius());
+    // Spread is applied to the cached ray instead of deprojecting a new screen point
+    Direction = ViewRay->GetDirectionAtScreenOffset(WeaponAccuracySpread);
+  }
+
+  OutStart = ViewRay->GetRayOrigin();
+  OutEnd = OutStart + Direction * (bShooting ? EquippedWeapon->GetMaxRange() : ItemTraceRange);
+  return true;
+}
+
+float AShooterCharacter::GetBulletSpreadRadius() const
+{
+  float const BulletSpreadFactor = (100.0f - EquippedWeapon->GetAccuracy()) / 100.0f;
+
+  // Twice the spread when shooting from the hip
+  return bAiming ? 80.f * BulletSpreadFactor : 80.f * BulletSpreadFactor * 2.0f;
+}
+
+FCollisionQueryParams AShooterCharacter::GetBulletQueryParams() const
+{
+  FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BulletTrace), false, this);
+  // Impact effects and penetration depend on the surface
+  QueryParams.bReturnPhysicalMaterial = true;
+  return QueryParams;
+}
+
 void AShooterCharacter::ApplyRecoil(float DeltaTime)
 {
   if (!VerticalRecoil && !HorizontalRecoil)
@@ -933,6 +1002,25 @@ void AShooterCharacter::EquipWeapon(AWeapon *WeaponToEquip)
   // Set EquippedWeapon to the newly spawned Weapon
   EquippedWeapon = WeaponToEquip;
   EquippedWeapon->SetItemState(EItemState::EIS_Equipped);
+
+  // The server checks submitted shots against its equipped weapon, it follows every swap, drop and pickup
+  if (!HasAuthority() && IsLocallyControlled())
+  {
+    ServerEquipWeapon(WeaponToEquip, WeaponToEquip->GetSlotIndex());
+  }
+
+  // Enough effects for a few frames of sustained fire
+  if (auto FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>())
+  {
+    FXPool->Prewarm(EquippedWeapon->GetMuzzleFlash(), 4);
+
+    // Beams are only the fallback of the instanced tracers
+    auto Tracers = GetWorld()->GetSubsystem<UTracerSubsystem>();
+    if (!Tracers || !Tracers->CanDrawTracers())
+    {
+      FXPool->Prewarm(EquippedWeapon->GetBeamParticles(), 8 * EquippedWeapon->GetPelletCount());
+    }
+  }
 }
 
 void AShooterCharacter::DropWeapon()
@@ -967,6 +1055,7 @@ void AShooterCharacter::InitializeAmmoMap()
 {
   AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
   AmmoMap.Add(EAmmoType::EAT_AssaultRifle, StartingARAmmo);
+  AmmoMap.Add(EAmmoType::EAT_Grenade, StartingGrenadeAmmo);
 }
 
 bool AShooterCharacter::WeaponHasAmmo()
@@ -979,13 +1068,38 @@ bool AShooterCharacter::WeaponHasAmmo()
 
 void AShooterCharacter::PlayFireSound()
 {
+  if (EquippedWeapon->UsesFireLoop())
+  {
+    // Already looping, later rounds cost nothing
+    if (FireAudioComponent->IsPlaying())
+      return;
+
+    FireAudioComponent->SetSound(EquippedWeapon->GetFireLoopSound());
+    FireAudioComponent->Play();
+    FireTailSound = EquippedWeapon->GetFireTailSound();
+  }
+
+  // First round of a loop, or every round of a semi-automatic weapon
   if (EquippedWeapon->GetFireSound())
   {
     UGameplayStatics::PlaySound2D(this, EquippedWeapon->GetFireSound());
   }
 }
 
-void AShooterCharacter::SendBullet()
+void AShooterCharacter::StopFireLoop()
+{
+  if (!FireAudioComponent->IsPlaying())
+    return;
+
+  FireAudioComponent->Stop();
+
+  if (FireTailSound)
+  {
+    UGameplayStatics::PlaySound2D(this, FireTailSound);
+  }
+}
+
+void AShooterCharacter::SendBullet(int32 Count)
 {
   const USkeletalMeshSocket *BarrelSocket = EquippedWeapon->GetItemMesh()->GetSocketByName("BarrelSocket");
   if (BarrelSocket)
@@ -994,84 +1108,666 @@ void AShooterCharacter::SendBullet()
 
     if (EquippedWeapon->GetMuzzleFlash())
     {
-      UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+      UImpactFXSubsystem::SpawnImpact(
+          this,
+          EImpactType::EIT_MuzzleFlash,
+          SocketTransform.GetLocation(),
+          SocketTransform.GetRotation().GetForwardVector(),
+          SurfaceType_Default,
+          static_cast<float>(Count),
+          EquippedWeapon->GetMuzzleFlash());
     }
 
-    FHitResult BeamHitResult;
-    bool bBeamEnd = GetBeamEndLocation(
-        SocketTransform.GetLocation(),
-        BeamHitResult);
+    if (EquippedWeapon->IsProjectileWeapon())
+    {
+      LaunchProjectiles(SocketTransform, Count);
+      return;
+    }
 
-    if (bBeamEnd)
+    const int32 PelletCount = EquippedWeapon->GetPelletCount();
+    for (int32 i = 0; i < Count; i++)
     {
-      // Spawn particles after updating correctly BeamEndPoint
-      // Check if hit actor implement BulletHitInterface
-      if (BeamHitResult.GetActor())
+      // Automatic weapons and shotguns resolve their hits with the next frame's async batch
+      if (bAsyncHitscan && PelletCount > 1)
+      {
+        QueuePellets(SocketTransform, PelletCount);
+        continue;
+      }
+      if (bAsyncHitscan && EquippedWeapon->GetAutomatic())
       {
-        IBulletHitInterface *BulletHitInterface = Cast<IBulletHitInterface>(BeamHitResult.GetActor());
+        QueueBullet(SocketTransform);
+        continue;
+      }
 
-        if (BulletHitInterface)
-        {
-          BulletHitInterface->BulletHit_Implementation(BeamHitResult, this, GetController());
-        }
-        else if (ImpactParticles) // Default particles
-        {
-          UGameplayStatics::SpawnEmitterAtLocation(
-              GetWorld(),
-              ImpactParticles,
-              BeamHitResult.Location,
-              FRotator(0.f),
-              true);
-        }
+      for (int32 Pellet = 0; Pellet < PelletCount; Pellet++)
+      {
+        FHitResult BeamHitResult;
+        bool bBeamEnd = GetBeamEndLocation(
+            SocketTransform.GetLocation(),
+            BeamHitResult);
 
-        AEnemy *HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
-        if (HitEnemy && !HitEnemy->IsDead())
+        if (bBeamEnd)
         {
-          int32 Damage{};
-          bool bWeakspot = false;
-
-          if (BeamHitResult.BoneName.ToString() == HitEnemy->GetWeakspotBone())
-          // Weakspot shot
-          {
-            Damage = EquippedWeapon->GetWeakspotDamage();
-            bWeakspot = true;
-          }
-          // Normal shot
-          else
-          {
-            Damage = EquippedWeapon->GetDamage();
-          }
-          UGameplayStatics::ApplyDamage(
-              HitEnemy,
-              Damage,
-              GetController(),
-              EquippedWeapon,
-              UDamageType::StaticClass());
-
-          HitEnemy->ShowHitNumber(Damage, BeamHitResult.Location, bWeakspot);
-          if (HitEnemy->GetHealth() - Damage > 0)
-          {
-            HitEnemy->TakeBalanceDamage(EquippedWeapon->GetBalanceDamage());
-          }
+          ResolveBulletPath(BeamHitResult, SocketTransform, EquippedWeapon);
         }
       }
+    }
 
-      if (EquippedWeapon->GetBeamParticles())
+    // Every ray of this volley goes to the server in one call
+    if (PendingClientShots.Num() > 0)
+    {
+      ServerSubmitShots(PendingClientShots, EquippedWeapon->GetWeaponType());
+      PendingClientShots.Reset();
+    }
+  }
+}
+
+void AShooterCharacter::ApplyBulletHit(const FHitResult &BeamHitResult, AWeapon *Weapon, float DamageScale)
+{
+  // Spawn particles after updating correctly BeamEndPoint
+  // Check if hit actor implement BulletHitInterface
+  if (BeamHitResult.GetActor())
+  {
+    IBulletHitInterface *BulletHitInterface = Cast<IBulletHitInterface>(BeamHitResult.GetActor());
+
+    if (BulletHitInterface)
+    {
+      BulletHitInterface->BulletHit_Implementation(BeamHitResult, this, GetController());
+    }
+    else if (!GetWorld()->IsNetMode(NM_DedicatedServer))
+    {
+      // Surface effects, the character's defaults when the surface has none
+      const FSurfaceImpactResponse *SurfaceResponse = GetSurfaceResponse(BeamHitResult);
+      UParticleSystem *SurfaceParticles = SurfaceResponse && SurfaceResponse->ImpactParticles ? SurfaceResponse->ImpactParticles : ImpactParticles;
+      UMaterialInterface *SurfaceDecal = SurfaceResponse && SurfaceResponse->Decal ? SurfaceResponse->Decal : BulletHoleDecal;
+      const float SurfaceDecalSize = SurfaceResponse && SurfaceResponse->Decal ? SurfaceResponse->DecalSize : BulletHoleSize;
+
+      // Scored with the other impacts of the frame, so bursts on a wall don't play a sound per pellet
+      if (auto ImpactSignificance = GetWorld()->GetSubsystem<UImpactSignificanceSubsystem>())
       {
-        UParticleSystemComponent *Beam = UGameplayStatics::SpawnEmitterAtLocation(
-            GetWorld(),
-            EquippedWeapon->GetBeamParticles(),
-            SocketTransform);
+        ImpactSignificance->QueueImpact(
+            BeamHitResult.GetActor(),
+            BeamHitResult,
+            SurfaceResponse ? SurfaceResponse->ImpactSound : nullptr,
+            SurfaceParticles);
+      }
 
-        if (Beam)
-        {
-          Beam->SetVectorParameter(FName("Target"), BeamHitResult.Location);
-        }
+      if (auto Decals = GetWorld()->GetSubsystem<UDecalSubsystem>())
+      {
+        Decals->AddBulletHole(BeamHitResult, SurfaceDecal, SurfaceDecalSize);
+      }
+    }
+
+    // Clients only play the effects, damage comes from the server check of their shots
+    AEnemy *HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
+    if (HitEnemy && !HitEnemy->IsDead() && HasAuthority())
+    {
+      int32 Damage{};
+      bool bWeakspot = false;
+      const FDamageZone *DamageZone = HitEnemy->GetDamageZone(BeamHitResult);
+      const float ZoneMultiplier = (DamageZone ? DamageZone->DamageMultiplier : 1.f) * DamageScale;
+
+      if (DamageZone && DamageZone->bWeakspot)
+      // Weakspot shot
+      {
+        Damage = FMath::TruncToInt32(Weapon->GetWeakspotDamage() * ZoneMultiplier);
+        bWeakspot = true;
+      }
+      // Normal shot
+      else
+      {
+        Damage = FMath::TruncToInt32(Weapon->GetDamage() * ZoneMultiplier);
+      }
+
+      // Summed with the other hits on the enemy this frame and applied once
+      if (auto DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>())
+      {
+        DamageQueue->QueueBulletDamage(
+            HitEnemy,
+            Damage,
+            Weapon->GetBalanceDamage() * DamageScale,
+            BeamHitResult.Location,
+            bWeakspot,
+            GetController(),
+            Weapon);
       }
     }
   }
 }
 
+void AShooterCharacter::SpawnBulletBeam(const FTransform &StartTransform, const FVector &EndLocation, const AWeapon *Weapon)
+{
+  // Dedicated servers only resolve hits
+  if (GetWorld()->IsNetMode(NM_DedicatedServer))
+    return;
+
+  // Instanced tracer when available, a beam emitter per segment otherwise
+  if (auto Tracers = GetWorld()->GetSubsystem<UTracerSubsystem>())
+  {
+    if (Tracers->AddTracer(
+            StartTransform.GetLocation(),
+            EndLocation,
+            Weapon->GetTracerColor(),
+            Weapon->GetTracerWidth()))
+      return;
+  }
+
+  if (Weapon->GetBeamParticles())
+  {
+    UParticleSystemComponent *Beam = UFXPoolSubsystem::SpawnPooledEmitter(
+        this,
+        Weapon->GetBeamParticles(),
+        StartTransform);
+
+    if (Beam)
+    {
+      Beam->SetVectorParameter(FName("Target"), EndLocation);
+    }
+  }
+}
+
+void AShooterCharacter::ResolveBulletPath(const FHitResult &FirstHit, const FTransform &SocketTransform, AWeapon *Weapon)
+{
+  ApplyBulletHit(FirstHit, Weapon);
+  SpawnBulletBeam(SocketTransform, FirstHit.Location, Weapon);
+
+  const int32 MaxPenetrations = Weapon->GetMaxPenetrations();
+  const int32 MaxRicochets = Weapon->GetMaxRicochets();
+  if (MaxPenetrations <= 0 && MaxRicochets <= 0)
+    return;
+
+  auto TraceBudget = GetWorld()->GetSubsystem<UTraceBudgetSubsystem>();
+  if (!TraceBudget)
+    return;
+
+  FCollisionQueryParams QueryParams = GetBulletQueryParams();
+  // Pawns come back as touches, so one trace finds every enemy in front of the next surface
+  FCollisionResponseParams ResponseParams;
+  ResponseParams.CollisionResponse.SetResponse(ECC_Pawn, ECR_Overlap);
+
+  FVector Direction = (FirstHit.TraceEnd - FirstHit.TraceStart).GetSafeNormal();
+  float RemainingRange = Weapon->GetMaxRange() - FVector::Dist(SocketTransform.GetLocation(), FirstHit.Location);
+  float DamageScale = 1.f;
+  int32 Penetrations = 0;
+  int32 Ricochets = 0;
+  TArray<const AActor *, TInlineAllocator<8>> PenetratedActors;
+
+  // Counts the enemy as penetrated, false if the bullet stops in it
+  auto PassThrough = [&](const FHitResult &EnemyHit)
+  {
+    if (Penetrations >= MaxPenetrations)
+      return false;
+
+    Penetrations++;
+    DamageScale *= Weapon->GetPenetrationDamageFalloff();
+    PenetratedActors.Add(EnemyHit.GetActor());
+    QueryParams.AddIgnoredActor(EnemyHit.GetActor());
+    return true;
+  };
+
+  FHitResult LastHit = FirstHit;
+  while (RemainingRange > 0.f)
+  {
+    FVector SegmentStart;
+    float SurfaceDamageFactor = 1.f;
+    if (Cast<AEnemy>(LastHit.GetActor()))
+    {
+      if (!PassThrough(LastHit))
+        return;
+
+      SegmentStart = LastHit.Location;
+    }
+    else if (Ricochets < MaxRicochets && CanRicochet(Direction, LastHit, Weapon))
+    {
+      Ricochets++;
+      DamageScale *= Weapon->GetRicochetDamageFactor();
+      Direction = Direction.MirrorByVector(LastHit.ImpactNormal);
+      // Start slightly off the surface so the bounce doesn't hit it again
+      SegmentStart = LastHit.Location + LastHit.ImpactNormal;
+    }
+    else if (Penetrations < MaxPenetrations && FindPenetrationExit(Direction, LastHit, SegmentStart, SurfaceDamageFactor))
+    {
+      Penetrations++;
+      DamageScale *= SurfaceDamageFactor;
+      RemainingRange -= FVector::Dist(LastHit.Location, SegmentStart);
+    }
+    else
+    {
+      return;
+    }
+
+    // Extra segments are dropped once the frame's trace budget is spent
+    if (!TraceBudget->TryConsumeTrace())
+      return;
+
+    const FVector SegmentEnd{SegmentStart + Direction * RemainingRange};
+    const FTransform SegmentTransform{Direction.Rotation(), SegmentStart};
+    TArray<FHitResult> SegmentHits;
+    GetWorld()->LineTraceMultiByChannel(
+        SegmentHits,
+        SegmentStart,
+        SegmentEnd,
+        ECC_Weapon,
+        QueryParams,
+        ResponseParams);
+
+    // Touches are sorted by distance, followed by the blocking hit if there is one
+    bool bBlocked = false;
+    for (const FHitResult &SegmentHit : SegmentHits)
+    {
+      if (SegmentHit.bBlockingHit)
+      {
+        ApplyBulletHit(SegmentHit, Weapon, DamageScale);
+        SpawnBulletBeam(SegmentTransform, SegmentHit.Location, Weapon);
+        RemainingRange -= SegmentHit.Distance;
+        LastHit = SegmentHit;
+        bBlocked = true;
+        break;
+      }
+
+      // Enemies report one touch per body, only the first one counts
+      const AActor *TouchedActor = SegmentHit.GetActor();
+      if (!Cast<AEnemy>(TouchedActor) || PenetratedActors.Contains(TouchedActor))
+        continue;
+
+      ApplyBulletHit(SegmentHit, Weapon, DamageScale);
+      if (!PassThrough(SegmentHit))
+      {
+        SpawnBulletBeam(SegmentTransform, SegmentHit.Location, Weapon);
+        return;
+      }
+    }
+
+    if (!bBlocked)
+    {
+      SpawnBulletBeam(SegmentTransform, SegmentEnd, Weapon);
+      return;
+    }
+  }
+}
+
+bool AShooterCharacter::CanRicochet(const FVector &Direction, const FHitResult &Hit, const AWeapon *Weapon) const
+{
+  // Pawns and actors reacting to bullets (explosives) never bounce them
+  AActor *HitActor = Hit.GetActor();
+  if (HitActor && (HitActor->IsA<APawn>() || HitActor->Implements<UBulletHitInterface>()))
+    return false;
+
+  // Angle between the shot and the surface, 0 when grazing it
+  const float ImpactAngle = FMath::RadiansToDegrees(
+      FMath::Asin(FMath::Clamp(-FVector::DotProduct(Direction, Hit.ImpactNormal), 0.f, 1.f)));
+
+  // Soft surfaces bullets go through bounce them less
+  const FSurfaceImpactResponse *SurfaceResponse = GetSurfaceResponse(Hit);
+  const float SurfaceHardness = SurfaceResponse ? 1.f - SurfaceResponse->PenetrationFactor : 1.f;
+
+  return ImpactAngle <= Weapon->GetRicochetMaxAngle() * SurfaceHardness;
+}
+
+bool AShooterCharacter::FindPenetrationExit(const FVector &Direction, const FHitResult &Hit, FVector &OutExit, float &OutDamageFactor) const
+{
+  const FSurfaceImpactResponse *SurfaceResponse = GetSurfaceResponse(Hit);
+  UPrimitiveComponent *HitComponent = Hit.GetComponent();
+  if (!SurfaceResponse || SurfaceResponse->PenetrationFactor <= 0.f || !HitComponent)
+    return false;
+
+  auto TraceBudget = GetWorld()->GetSubsystem<UTraceBudgetSubsystem>();
+  if (!TraceBudget || !TraceBudget->TryConsumeTrace())
+    return false;
+
+  // Traced back against the hit component only, the first hit from behind is where the bullet comes out
+  FHitResult ExitHit;
+  const FVector ExitTraceStart{Hit.Location + Direction * MaxWallThickness};
+  if (!HitComponent->LineTraceComponent(ExitHit, ExitTraceStart, Hit.Location, GetBulletQueryParams()))
+    return false;
+
+  // Start inside the exit would hit the surface again
+  if (ExitHit.bStartPenetrating)
+    return false;
+
+  OutExit = ExitHit.Location + Direction;
+  OutDamageFactor = SurfaceResponse->PenetrationFactor;
+  return true;
+}
+
+const FSurfaceImpactResponse *AShooterCharacter::GetSurfaceResponse(const FHitResult &Hit) const
+{
+  auto SurfaceImpacts = GetGameInstance() ? GetGameInstance()->GetSubsystem<USurfaceImpactSubsystem>() : nullptr;
+  return SurfaceImpacts ? SurfaceImpacts->GetResponse(Hit) : nullptr;
+}
+
+void AShooterCharacter::LaunchProjectiles(const FTransform &SocketTransform, int32 Count)
+{
+  auto Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+  if (!Projectiles)
+    return;
+
+  const FVector MuzzleLocation{SocketTransform.GetLocation()};
+  for (int32 i = 0; i < Count; i++)
+  {
+    // Aim at what is under the crosshair, with spread
+    FHitResult CrosshairHitResult;
+    FVector AimLocation{MuzzleLocation + GetControlRotation().Vector() * EquippedWeapon->GetMaxRange()};
+    TraceUnderCrosshair(CrosshairHitResult, AimLocation, true);
+
+    Projectiles->LaunchProjectile(
+        MuzzleLocation,
+        AimLocation - MuzzleLocation,
+        EquippedWeapon->GetProjectileProperties(),
+        EquippedWeapon->GetDamage(),
+        EquippedWeapon,
+        GetController(),
+        this);
+    RecordClientShot(MuzzleLocation, AimLocation);
+  }
+
+  // Projectiles of clients only show, the server launches its own from the submitted shots and deals their damage
+  if (PendingClientShots.Num() > 0)
+  {
+    ServerSubmitShots(PendingClientShots, EquippedWeapon->GetWeaponType());
+    PendingClientShots.Reset();
+  }
+}
+
+void AShooterCharacter::QueueBullet(const FTransform &SocketTransform)
+{
+  FVector CrosshairTraceStart;
+  FVector CrosshairTraceEnd;
+  if (GetCrosshairTrace(CrosshairTraceStart, CrosshairTraceEnd, true))
+  {
+    QueueShot(SocketTransform, CrosshairTraceStart, CrosshairTraceEnd);
+  }
+}
+
+void AShooterCharacter::QueuePellets(const FTransform &SocketTransform, int32 PelletCount)
+{
+  if (!ViewRay || !ViewRay->HasValidRay())
+    return;
+
+  TArray<FVector> PelletDirections;
+  ViewRay->GetDirectionsInScreenCircle(GetBulletSpreadRadius(), PelletCount, PelletDirections);
+
+  // Pellets hitting the same enemy are summed by the damage queue into a single hit
+  const FVector CrosshairTraceStart{ViewRay->GetRayOrigin()};
+  for (const FVector &PelletDirection : PelletDirections)
+  {
+    QueueShot(SocketTransform, CrosshairTraceStart, CrosshairTraceStart + PelletDirection * EquippedWeapon->GetMaxRange());
+  }
+}
+
+void AShooterCharacter::QueueShot(const FTransform &SocketTransform, const FVector &CrosshairTraceStart, const FVector &CrosshairTraceEnd)
+{
+  RecordClientShot(CrosshairTraceStart, CrosshairTraceEnd);
+
+  // Both rays are requested now, so the whole frame of shots is resolved in a single batch.
+  // The barrel ray aims at the crosshair ray end instead of the (still unknown) crosshair hit.
+  const FVector MuzzleLocation{SocketTransform.GetLocation()};
+  const FVector StartToEnd{CrosshairTraceEnd - MuzzleLocation};
+
+  FQueuedShot Shot;
+  Shot.SocketTransform = SocketTransform;
+  Shot.Weapon = EquippedWeapon;
+  Shot.CrosshairTraceStart = CrosshairTraceStart;
+  Shot.CrosshairTraceEnd = CrosshairTraceEnd;
+  Shot.CrosshairTraceHandle = GetWorld()->AsyncLineTraceByChannel(
+      EAsyncTraceType::Single,
+      CrosshairTraceStart,
+      CrosshairTraceEnd,
+      ECC_Weapon,
+      GetBulletQueryParams());
+  Shot.BarrelTraceHandle = GetWorld()->AsyncLineTraceByChannel(
+      EAsyncTraceType::Single,
+      MuzzleLocation,
+      MuzzleLocation + StartToEnd * 1.25f,
+      ECC_Weapon,
+      GetBulletQueryParams());
+  Shot.FrameQueued = GFrameCounter;
+
+  if (auto TraceBudget = GetWorld()->GetSubsystem<UTraceBudgetSubsystem>())
+  {
+    TraceBudget->RecordTraces(2);
+  }
+
+  QueuedShots.Add(Shot);
+}
+
+void AShooterCharacter::RecordClientShot(const FVector &TraceStart, const FVector &TraceEnd)
+{
+  if (HasAuthority())
+    return;
+
+  const AGameStateBase *GameState = GetWorld()->GetGameState();
+  const float ServerTime = GameState ? static_cast<float>(GameState->GetServerWorldTimeSeconds()) : GetWorld()->GetTimeSeconds();
+
+  // Enemies on screen are where the server had them half a round trip ago, smoothed on top of that
+  const APlayerState *ShooterPlayerState = GetPlayerState();
+  const float OneWayLatency = ShooterPlayerState ? ShooterPlayerState->GetPingInMilliseconds() * 0.0005f : 0.f;
+
+  FClientShot &Shot = PendingClientShots.AddDefaulted_GetRef();
+  Shot.TraceStart = TraceStart;
+  Shot.TraceEnd = TraceEnd;
+  Shot.FireTime = ServerTime - OneWayLatency - ClientInterpolationDelay;
+}
+
+void AShooterCharacter::ServerSubmitShots_Implementation(const TArray<FClientShot> &Shots, EWeaponType WeaponType)
+{
+  auto LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+  if (!LagCompensation || !EquippedWeapon || bDead)
+    return;
+
+  // Shots are paid for with the server's equipped weapon, fired with another one they are rejected
+  if (WeaponType != EquippedWeapon->GetWeaponType())
+    return;
+
+  // Each shot is one ray, shotgun rounds send one per pellet
+  const int32 PelletCount = EquippedWeapon->GetPelletCount();
+  const int32 MaxRays = PelletCount * MaxClientRoundsPerSubmit;
+  if (Shots.Num() > MaxRays)
+    return;
+
+  // The allowance refills at the fire rate, so shots can't come faster than the weapon fires
+  const float Time = GetWorld()->GetTimeSeconds();
+  const float FireRate = FMath::Max(EquippedWeapon->GetFireRate(), KINDA_SMALL_NUMBER);
+  ClientShotAllowance = FMath::Min(ClientShotAllowance + (Time - LastClientShotTime) / FireRate * PelletCount, static_cast<float>(MaxRays));
+  LastClientShotTime = Time;
+
+  const int32 AcceptedShots = FMath::Min3(
+      Shots.Num(),
+      FMath::FloorToInt32(ClientShotAllowance),
+      EquippedWeapon->GetAmmo() * PelletCount);
+  if (AcceptedShots <= 0)
+    return;
+
+  ClientShotAllowance -= AcceptedShots;
+  EquippedWeapon->ConsumeAmmo(FMath::DivideAndRoundUp(AcceptedShots, PelletCount));
+
+  for (int32 i = 0; i < AcceptedShots; i++)
+  {
+    const FClientShot &Shot = Shots[i];
+
+    // Shots must start around the character and can't reach further than the weapon
+    if (FVector::DistSquared(Shot.TraceStart, GetActorLocation()) > FMath::Square(MaxClientShotOffset))
+      continue;
+
+    // Projectile shots are the launch seen by the client, simulated from now on
+    if (EquippedWeapon->IsProjectileWeapon())
+    {
+      if (auto Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>())
+      {
+        Projectiles->LaunchProjectile(
+            Shot.TraceStart,
+            Shot.TraceEnd - Shot.TraceStart,
+            EquippedWeapon->GetProjectileProperties(),
+            EquippedWeapon->GetDamage(),
+            EquippedWeapon,
+            GetController(),
+            this);
+      }
+      continue;
+    }
+
+    const FVector TraceDirection{(Shot.TraceEnd - Shot.TraceStart).GetSafeNormal()};
+    LagCompensation->QueueShot(
+        this,
+        Shot.TraceStart,
+        Shot.TraceStart + TraceDirection * EquippedWeapon->GetMaxRange(),
+        Shot.FireTime);
+  }
+}
+
+void AShooterCharacter::ServerReloadWeapon_Implementation()
+{
+  if (!EquippedWeapon || bDead)
+    return;
+
+  FillMagazine();
+}
+
+void AShooterCharacter::ServerEquipWeapon_Implementation(AWeapon *Weapon, int32 SlotIndex)
+{
+  if (bDead)
+    return;
+
+  // Weapons spawned on the client, like the default one, aren't known to the server and arrive as null
+  AWeapon *ServerWeapon = Weapon ? Weapon : (Inventory.IsValidIndex(SlotIndex) ? Cast<AWeapon>(Inventory[SlotIndex]) : nullptr);
+  if (!ServerWeapon || ServerWeapon == EquippedWeapon)
+    return;
+
+  if (!EquippedWeapon)
+  {
+    EquipWeapon(ServerWeapon);
+    return;
+  }
+
+  if (Inventory.Contains(ServerWeapon))
+  {
+    // Switched to another weapon of the inventory
+    WeaponToGrab = ServerWeapon;
+    GrabWeapon();
+    return;
+  }
+
+  // Picked up on the client, only weapons lying in the world can be taken
+  if (ServerWeapon->GetItemState() != EItemState::EIS_Pickup)
+    return;
+
+  if (SlotIndex == EquippedWeapon->GetSlotIndex())
+  {
+    SwapWeapon(ServerWeapon);
+  }
+  else if (SlotIndex == Inventory.Num() && Inventory.Num() < MAIN_INVENTORY_CAPACITY)
+  {
+    ServerWeapon->SetSlotIndex(SlotIndex);
+    Inventory.Add(ServerWeapon);
+    WeaponToGrab = ServerWeapon;
+    GrabWeapon();
+  }
+}
+
+void AShooterCharacter::ResolveRewoundShot(const FVector &TraceStart, const FVector &TraceEnd)
+{
+  if (!EquippedWeapon)
+    return;
+
+  FHitResult ShotHitResult;
+  if (GetWorld()->LineTraceSingleByChannel(ShotHitResult, TraceStart, TraceEnd, ECC_Weapon, GetBulletQueryParams()))
+  {
+    ResolveBulletPath(ShotHitResult, FTransform(TraceStart), EquippedWeapon);
+  }
+}
+
+void AShooterCharacter::ResolveQueuedShots()
+{
+  if (QueuedShots.Num() == 0)
+    return;
+
+  UWorld *World = GetWorld();
+  // Barrel hits closer than the crosshair hit by more than this are obstacles in front of the gun
+  const float ObstructionTolerance{10.f};
+
+  for (int32 i = 0; i < QueuedShots.Num(); i++)
+  {
+    const FQueuedShot &Shot = QueuedShots[i];
+    if (Shot.FrameQueued == GFrameCounter)
+    {
+      // Fired this frame, results come next frame
+      continue;
+    }
+
+    // Shots of a weapon destroyed since have no stats left to apply
+    AWeapon *Weapon = Shot.Weapon.Get();
+    if (!Weapon)
+    {
+      QueuedShots.RemoveAt(i--, 1, false);
+      continue;
+    }
+
+    const FVector MuzzleLocation{Shot.SocketTransform.GetLocation()};
+    const FVector BarrelTraceEnd{MuzzleLocation + (Shot.CrosshairTraceEnd - MuzzleLocation) * 1.25f};
+
+    FTraceDatum CrosshairData;
+    FTraceDatum BarrelData;
+    const bool bResultsReady =
+        World->QueryTraceData(Shot.CrosshairTraceHandle, CrosshairData) &&
+        World->QueryTraceData(Shot.BarrelTraceHandle, BarrelData);
+
+    FHitResult CrosshairHitResult;
+    FHitResult BarrelHitResult;
+    bool bCrosshairHit = false;
+    bool bBarrelHit = false;
+    if (bResultsReady)
+    {
+      bCrosshairHit = CrosshairData.OutHits.Num() > 0 && CrosshairData.OutHits[0].bBlockingHit;
+      if (bCrosshairHit)
+      {
+        CrosshairHitResult = CrosshairData.OutHits[0];
+      }
+
+      bBarrelHit = BarrelData.OutHits.Num() > 0 && BarrelData.OutHits[0].bBlockingHit;
+      if (bBarrelHit)
+      {
+        BarrelHitResult = BarrelData.OutHits[0];
+      }
+    }
+    else if (GFrameCounter - Shot.FrameQueued < 2)
+    {
+      // Not done yet, given one more frame
+      continue;
+    }
+    else
+    {
+      // Results expired after a hitch, the shot is traced now instead of lost
+      bCrosshairHit = World->LineTraceSingleByChannel(CrosshairHitResult, Shot.CrosshairTraceStart, Shot.CrosshairTraceEnd, ECC_Weapon, GetBulletQueryParams());
+      bBarrelHit = World->LineTraceSingleByChannel(BarrelHitResult, MuzzleLocation, BarrelTraceEnd, ECC_Weapon, GetBulletQueryParams());
+
+      if (auto TraceBudget = World->GetSubsystem<UTraceBudgetSubsystem>())
+      {
+        TraceBudget->RecordTraces(2);
+      }
+    }
+
+    if (bCrosshairHit)
+    {
+      const float CrosshairHitDistance = FVector::Dist(MuzzleLocation, CrosshairHitResult.Location);
+      if (bBarrelHit && BarrelHitResult.Distance < CrosshairHitDistance - ObstructionTolerance)
+      {
+        // Object between barrel and crosshair hit
+        ResolveBulletPath(BarrelHitResult, Shot.SocketTransform, Weapon);
+      }
+      else
+      {
+        ResolveBulletPath(CrosshairHitResult, Shot.SocketTransform, Weapon);
+      }
+    }
+    else if (bBarrelHit)
+    {
+      ResolveBulletPath(BarrelHitResult, Shot.SocketTransform, Weapon);
+    }
+
+    QueuedShots.RemoveAt(i--, 1, false);
+  }
+}
+
 void AShooterCharacter::PlayGunFireMontage()
 {
   UAnimInstance *AnimInstance = GetMesh()->GetAnimInstance();
@@ -1530,6 +2226,8 @@ void AShooterCharacter::Tick(float DeltaTime)
   CameraInterpZoom(DeltaTime);
   SetLookRate();
   CalculateCrosshairSpread(DeltaTime);
+  UpdateFireScheduler(DeltaTime);
+  ResolveQueuedShots();
   TraceForItems();
   ApplyRecoil(DeltaTime);
   HandleSprint(DeltaTime);
@@ -1582,6 +2280,22 @@ void AShooterCharacter::FinishReloading()
   if (!EquippedWeapon)
     return;
 
+  FillMagazine();
+
+  // The server reloads its copy of the weapon too, it pays for the shots of this client
+  if (!HasAuthority())
+  {
+    ServerReloadWeapon();
+  }
+
+  if (bFireButtonPressed && EquippedWeapon->GetAutomatic() && !bDead)
+  {
+    FireWeapon();
+  }
+}
+
+void AShooterCharacter::FillMagazine()
+{
   const auto AmmoType = EquippedWeapon->GetAmmoType();
   // Update carrying ammo amount
   if (AmmoMap.Contains(AmmoType))
@@ -1605,11 +2319,6 @@ void AShooterCharacter::FinishReloading()
       AmmoMap.Add(AmmoType, CarriedAmmo);
     }
   }
-
-  if (bFireButtonPressed && EquippedWeapon->GetAutomatic() && !bDead)
-  {
-    FireWeapon();
-  }
 }
 
 void AShooterCharacter::ResetPickupSoundTimer()
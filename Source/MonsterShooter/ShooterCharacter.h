@@ -6,8 +6,10 @@
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
 #include "AmmoType.h"
+#include "WeaponType.h"
 #include "Engine/DataTable.h"
 #include "CharacterName.h"
+#include "WorldCollision.h"
 #include "ShooterCharacter.generated.h"
 
 USTRUCT(BlueprintType)
@@ -78,6 +80,46 @@ struct FInterpLocation
   int32 ItemCount;
 };
 
+/** Hitscan shot waiting for its async trace results */
+struct FQueuedShot
+{
+  // Barrel socket transform at the time the shot was fired
+  FTransform SocketTransform;
+
+  // Weapon that fired the shot, its stats apply even if another one is equipped since
+  TWeakObjectPtr<class AWeapon> Weapon;
+
+  // Crosshair ray, traced again synchronously if its async results are lost
+  FVector CrosshairTraceStart;
+  FVector CrosshairTraceEnd;
+
+  // Async trace from the crosshair outward
+  FTraceHandle CrosshairTraceHandle;
+
+  // Async trace from the barrel towards the crosshair ray end
+  FTraceHandle BarrelTraceHandle;
+
+  // Frame the traces were requested on, results are only valid on the next one
+  uint64 FrameQueued;
+};
+
+/** Shot fired on a client, sent to the server to be checked with lag compensation */
+USTRUCT()
+struct FClientShot
+{
+  GENERATED_BODY()
+
+  UPROPERTY()
+  FVector_NetQuantize TraceStart;
+
+  UPROPERTY()
+  FVector_NetQuantize TraceEnd;
+
+  /** Server time of the poses the client saw when firing, what the server rewinds to */
+  UPROPERTY()
+  float FireTime = 0.f;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(
     FEquipItemDelegate,
     int32, CurrentSlotIndex,
@@ -183,13 +225,23 @@ protected:
 
   bool GetBeamEndLocation(const FVector &MuzzleSocketLocation, FHitResult &OutHitResult);
 
-  void StartFireTimer();
+  /** Fires the rounds that became due this frame while the fire timer is in progress */
+  void UpdateFireScheduler(float DeltaTime);
 
-  UFUNCTION()
-  void AutoFireReset();
+  /** Fires Count rounds as one batch: one sound, montage and recoil, Count rays and one ammo decrement */
+  void FireRounds(int32 Count);
 
   bool TraceUnderCrosshair(FHitResult &OutHitResult, FVector &OutHitLocation, bool bShooting = false);
 
+  /** Start and end of the ray going out of the crosshair, with bullet spread applied when shooting */
+  bool GetCrosshairTrace(FVector &OutStart, FVector &OutEnd, bool bShooting = false);
+
+  /** Radius of the bullet spread around the crosshair, in screen pixels */
+  float GetBulletSpreadRadius() const;
+
+  /** Query params shared by every bullet trace */
+  FCollisionQueryParams GetBulletQueryParams() const;
+
   void ApplyRecoil(float DeltaTime);
 
   /** Trace for items if OverlappedItemCount >= 0 */
@@ -215,15 +267,71 @@ protected:
 
   // Fire weapon functions
   void PlayFireSound();
-  void SendBullet();
+  /** Stops the fire loop of an automatic weapon and plays its tail */
+  void StopFireLoop();
+  void SendBullet(int32 Count = 1);
   void PlayGunFireMontage();
 
+  /** Applies damage and effects of a bullet of Weapon that hit BeamHitResult, DamageScale is reduced by penetrations and ricochets */
+  void ApplyBulletHit(const FHitResult &BeamHitResult, AWeapon *Weapon, float DamageScale = 1.f);
+
+  /** Spawns the bullet trail from StartTransform to EndLocation */
+  void SpawnBulletBeam(const FTransform &StartTransform, const FVector &EndLocation, const AWeapon *Weapon);
+
+  /** Applies the first hit of a shot, then follows the bullet through enemies and off surfaces as Weapon allows */
+  void ResolveBulletPath(const FHitResult &FirstHit, const FTransform &SocketTransform, AWeapon *Weapon);
+
+  /** If a bullet going in Direction bounces off the surface it hit */
+  bool CanRicochet(const FVector &Direction, const FHitResult &Hit, const AWeapon *Weapon) const;
+
+  /** Finds where a bullet going in Direction comes out of the surface it hit, false if it can't go through */
+  bool FindPenetrationExit(const FVector &Direction, const FHitResult &Hit, FVector &OutExit, float &OutDamageFactor) const;
+
+  /** Response of the surface hit by a bullet, from DT_SurfaceImpacts */
+  const struct FSurfaceImpactResponse *GetSurfaceResponse(const FHitResult &Hit) const;
+
+  /** Fires Count projectiles of a projectile weapon towards the crosshair */
+  void LaunchProjectiles(const FTransform &SocketTransform, int32 Count);
+
+  /** Requests the crosshair and barrel traces of a shot asynchronously */
+  void QueueBullet(const FTransform &SocketTransform);
+
+  /** Queues every pellet of a shotgun round, with their spread generated in one batch */
+  void QueuePellets(const FTransform &SocketTransform, int32 PelletCount);
+
+  /** Requests the traces of a shot going along the given crosshair ray */
+  void QueueShot(const FTransform &SocketTransform, const FVector &CrosshairTraceStart, const FVector &CrosshairTraceEnd);
+
+  /** On clients, keeps the crosshair ray of a shot, or the launch ray of a projectile, to send it to the server */
+  void RecordClientShot(const FVector &TraceStart, const FVector &TraceEnd);
+
+  /** Sends the shots fired on a client with a weapon of WeaponType to the server, where they are checked with lag compensation */
+  UFUNCTION(Server, Reliable)
+  void ServerSubmitShots(const TArray<FClientShot> &Shots, EWeaponType WeaponType);
+  void ServerSubmitShots_Implementation(const TArray<FClientShot> &Shots, EWeaponType WeaponType);
+
+  /** Reloads the server copy of the equipped weapon, which pays for the shots clients submit */
+  UFUNCTION(Server, Reliable)
+  void ServerReloadWeapon();
+  void ServerReloadWeapon_Implementation();
+
+  /** Equips on the server the weapon equipped on the client, Weapon is null when it can't be sent and SlotIndex finds it */
+  UFUNCTION(Server, Reliable)
+  void ServerEquipWeapon(AWeapon *Weapon, int32 SlotIndex);
+  void ServerEquipWeapon_Implementation(AWeapon *Weapon, int32 SlotIndex);
+
+  /** Applies the hits of the shots queued last frame */
+  void ResolveQueuedShots();
+
   // Reload functions
   void ReloadWeapon();
 
   UFUNCTION(BlueprintCallable)
   void FinishReloading();
 
+  /** Moves carried ammo of the equipped weapon's type into its magazine */
+  void FillMagazine();
+
   /** Checks to see if we have ammo of the EquippedWeapon's ammo type */
   bool CarryingAmmo();
 
@@ -293,6 +401,18 @@ private:
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
   class UCameraComponent *FollowCamera;
 
+  // Crosshair ray cached once per frame, shared by every aim trace
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+  class UViewRayComponent *ViewRay;
+
+  // Plays the fire loop of automatic weapons, one voice at any fire rate
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  class UAudioComponent *FireAudioComponent;
+
+  /** Tail of the weapon whose loop is playing, the weapon may be swapped before the loop stops */
+  UPROPERTY()
+  class USoundCue *FireTailSound;
+
   // Montage for firing the weapon
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
   UAnimMontage *HipFireMontage;
@@ -352,10 +472,50 @@ private:
   FTimerHandle CrosshairShootTimer;
   /** If the fire input is pressed */
   bool bFireButtonPressed;
-  /** True when the weapon can fire, false when waiting for the timer */
-  bool bShouldFire;
-  /** Sets a timer between gunshots */
-  FTimerHandle AutoFireTimer;
+  /** Time accumulated towards the next round, keeps the remainder so the fire rate is exact at any frame rate */
+  float FireTimeAccumulator;
+  /** Frame the first round of a burst was fired on, its DeltaTime doesn't count towards the next round */
+  uint64 FireStartFrame;
+
+  /** When true, shots from automatic weapons are traced as one async batch and resolved on the next frame */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  bool bAsyncHitscan;
+
+  /** Shots waiting for their async trace results */
+  TArray<FQueuedShot> QueuedShots;
+
+  /** Shots fired on this client since the last send to the server */
+  TArray<FClientShot> PendingClientShots;
+
+  /** Furthest a client shot can start from the character before the server rejects it */
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  float MaxClientShotOffset;
+
+  /** Most rounds one submit from a client may carry, frame hitches batch several rounds together */
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  int32 MaxClientRoundsPerSubmit;
+
+  /** Seconds the simulated enemies a client sees lag behind their replicated location, from movement smoothing */
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  float ClientInterpolationDelay;
+
+  /** On the server, rays a client may still submit, refilled at the fire rate of the equipped weapon */
+  float ClientShotAllowance;
+
+  /** Server time the shot allowance was last refilled */
+  float LastClientShotTime;
+
+  /** Thickest surface a bullet can go through */
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  float MaxWallThickness;
+
+  // Decal left by bullets on static world geometry
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  class UMaterialInterface *BulletHoleDecal;
+
+  // Size of the bullet hole decal
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+  float BulletHoleSize;
 
   /** Memorizes the Item currently being aimed at */
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
@@ -364,6 +524,10 @@ private:
   /** True if we should trace every frame for items */
   bool bShouldTraceForItems;
 
+  /** Maximum distance from the camera the item trace reaches */
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+  float ItemTraceRange;
+
   /** Number of overlapped AItems */
   int8 OverlappedItemCount;
 
@@ -397,6 +561,9 @@ private:
   /** Starting amount of assault rifle ammo */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
   int32 StartingARAmmo;
+  /** Starting amount of grenades */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
+  int32 StartingGrenadeAmmo;
 
   /** Combat state, can only fire or reload when Unoccupied */
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -580,6 +747,8 @@ public:
   FORCEINLINE USpringArmComponent *GetCameraBoom() const { return CameraBoom; }
   // Returns FollowCamera subobject
   FORCEINLINE UCameraComponent *GetFollowCamera() const { return FollowCamera; }
+  // Returns ViewRay subobject
+  FORCEINLINE UViewRayComponent *GetViewRay() const { return ViewRay; }
 
   FORCEINLINE bool GetAiming() const { return bAiming; }
 
@@ -622,4 +791,7 @@ public:
   void Stagger();
 
   void Heal(float Amount);
+
+  /** Server side check of a client shot, called while the hitboxes are rewound to the client fire time */
+  void ResolveRewoundShot(const FVector &TraceStart, const FVector &TraceEnd);
 };
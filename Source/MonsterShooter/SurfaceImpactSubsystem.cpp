@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SurfaceImpactSubsystem.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+void USurfaceImpactSubsystem::Initialize(FSubsystemCollectionBase &Collection)
+{
+  Super::Initialize(Collection);
+
+  Responses.SetNum(SurfaceType_Max);
+  ValidResponses.Init(false, SurfaceType_Max);
+
+  const FString SurfaceTablePath{TEXT("/Script/Engine.DataTable'/Game/_Game/DataTable/DT_SurfaceImpacts.DT_SurfaceImpacts'")};
+  UDataTable *SurfaceTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *SurfaceTablePath, nullptr, LOAD_NoWarn));
+  if (!SurfaceTableObject)
+    return;
+
+  TArray<FSurfaceImpactResponse *> Rows;
+  SurfaceTableObject->GetAllRows<FSurfaceImpactResponse>(TEXT(""), Rows);
+
+  for (const FSurfaceImpactResponse *Row : Rows)
+  {
+    Responses[Row->Surface] = *Row;
+    ValidResponses[Row->Surface] = true;
+  }
+
+  // Surfaces without a row share the default one
+  if (ValidResponses[SurfaceType_Default])
+  {
+    for (int32 Surface = 0; Surface < SurfaceType_Max; Surface++)
+    {
+      if (!ValidResponses[Surface])
+      {
+        Responses[Surface] = Responses[SurfaceType_Default];
+        ValidResponses[Surface] = true;
+      }
+    }
+  }
+}
+
+const FSurfaceImpactResponse *USurfaceImpactSubsystem::GetResponse(const FHitResult &Hit) const
+{
+  const EPhysicalSurface Surface = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+  return ValidResponses[Surface] ? &Responses[Surface] : nullptr;
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/DataTable.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "SurfaceImpactSubsystem.generated.h"
+
+/** How bullets react to a physical surface, one row per surface in DT_SurfaceImpacts */
+USTRUCT(BlueprintType)
+struct FSurfaceImpactResponse : public FTableRowBase
+{
+  GENERATED_BODY()
+
+  /** Surface this row applies to, rows for SurfaceType_Default are used by every surface without a row */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  TEnumAsByte<EPhysicalSurface> Surface = SurfaceType_Default;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  class UParticleSystem *ImpactParticles = nullptr;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  class USoundCue *ImpactSound = nullptr;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  class UMaterialInterface *Decal = nullptr;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float DecalSize = 5.f;
+
+  /** Damage kept by a bullet going through the surface, 0 for surfaces bullets can't go through */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"))
+  float PenetrationFactor = 0.f;
+};
+
+/**
+ * Compiles DT_SurfaceImpacts once per game into a flat array indexed by EPhysicalSurface,
+ * so resolving the effects of a bullet hit is one array lookup
+ */
+UCLASS()
+class MONSTERSHOOTER_API USurfaceImpactSubsystem : public UGameInstanceSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void Initialize(FSubsystemCollectionBase &Collection) override;
+
+  /** Response to the surface of Hit, null when the table has no row for it nor a default row */
+  const FSurfaceImpactResponse *GetResponse(const FHitResult &Hit) const;
+
+private:
+  /** One entry per EPhysicalSurface */
+  UPROPERTY()
+  TArray<FSurfaceImpactResponse> Responses;
+
+  /** If the entry of a surface comes from a table row */
+  TBitArray<> ValidResponses;
+};
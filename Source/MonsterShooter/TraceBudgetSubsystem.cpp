@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TraceBudgetSubsystem.h"
+
+static TAutoConsoleVariable<int32> CVarBulletTraceBudget(
+    TEXT("MonsterShooter.BulletTraceBudget"),
+    96,
+    TEXT("Maximum number of bullet traces per frame. Penetration and ricochet segments past this are skipped."),
+    ECVF_Default);
+
+void UTraceBudgetSubsystem::RecordTraces(int32 Count)
+{
+  RefreshFrame();
+  TracesThisFrame += Count;
+}
+
+bool UTraceBudgetSubsystem::TryConsumeTrace()
+{
+  RefreshFrame();
+  if (TracesThisFrame >= CVarBulletTraceBudget.GetValueOnGameThread())
+    return false;
+
+  TracesThisFrame++;
+  return true;
+}
+
+bool UTraceBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTraceBudgetSubsystem::RefreshFrame()
+{
+  if (BudgetFrame != GFrameCounter)
+  {
+    BudgetFrame = GFrameCounter;
+    TracesThisFrame = 0;
+  }
+}
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TraceBudgetSubsystem.generated.h"
+
+/**
+ * Per frame budget of bullet traces. The first trace of every shot always runs and is only counted,
+ * extra segments (penetration, ricochet) are skipped once the budget for the frame is spent
+ */
+UCLASS()
+class MONSTERSHOOTER_API UTraceBudgetSubsystem : public UWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  /** Counts traces that run regardless of the budget */
+  void RecordTraces(int32 Count);
+
+  /** Takes one trace from the frame budget, false if it is already spent */
+  bool TryConsumeTrace();
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Starts a new count when the frame changes */
+  void RefreshFrame();
+
+  /** Frame the trace count belongs to */
+  uint64 BudgetFrame = 0;
+
+  /** Traces performed during BudgetFrame */
+  int32 TracesThisFrame = 0;
+};
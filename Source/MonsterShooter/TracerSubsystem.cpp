@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TracerSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInterface.h"
+
+static TAutoConsoleVariable<float> CVarTracerLifetime(
+    TEXT("MonsterShooter.FX.TracerLifetime"),
+    0.12f,
+    TEXT("Seconds a bullet tracer takes to fade out."),
+    ECVF_Default);
+
+void UTracerSubsystem::OnWorldBeginPlay(UWorld &InWorld)
+{
+  Super::OnWorldBeginPlay(InWorld);
+
+  for (int32 Slot = 0; Slot < TracerCapacity; Slot++)
+  {
+    EndTimes[Slot] = -1.f;
+  }
+
+  if (InWorld.IsNetMode(NM_DedicatedServer))
+    return;
+
+  // Unit length mesh along X, scaled to the length of each tracer. Optional, beams are used without it
+  const FString TracerMeshPath{TEXT("/Script/Engine.StaticMesh'/Game/_Game/FX/SM_Tracer.SM_Tracer'")};
+  UStaticMesh *TracerMesh = Cast<UStaticMesh>(StaticLoadObject(UStaticMesh::StaticClass(), nullptr, *TracerMeshPath, nullptr, LOAD_NoWarn));
+  if (!TracerMesh)
+    return;
+
+  // Fades itself with the material time, from the spawn time and lifetime in the per instance custom data
+  const FString TracerMaterialPath{TEXT("/Script/Engine.Material'/Game/_Game/FX/M_Tracer.M_Tracer'")};
+  UMaterialInterface *TracerMaterial = Cast<UMaterialInterface>(StaticLoadObject(UMaterialInterface::StaticClass(), nullptr, *TracerMaterialPath, nullptr, LOAD_NoWarn));
+
+  TracerComponent = NewObject<UInstancedStaticMeshComponent>(InWorld.GetWorldSettings());
+  TracerComponent->SetStaticMesh(TracerMesh);
+  if (TracerMaterial)
+  {
+    TracerComponent->SetMaterial(0, TracerMaterial);
+  }
+  TracerComponent->SetAbsolute(true, true, true);
+  TracerComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  TracerComponent->SetCastShadow(false);
+  TracerComponent->SetMobility(EComponentMobility::Movable);
+  TracerComponent->NumCustomDataFloats = NumCustomData;
+  TracerComponent->RegisterComponentWithWorld(&InWorld);
+
+  // Every slot exists from the start, hidden with a zero scale until used
+  TArray<FTransform> HiddenTransforms;
+  HiddenTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), TracerCapacity);
+  TracerComponent->AddInstances(HiddenTransforms, false, true);
+}
+
+void UTracerSubsystem::Deinitialize()
+{
+  if (IsValid(TracerComponent))
+  {
+    TracerComponent->DestroyComponent();
+  }
+  TracerComponent = nullptr;
+
+  Super::Deinitialize();
+}
+
+void UTracerSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  if (NumActive == 0 || !IsValid(TracerComponent))
+    return;
+
+  // The material does the fading, faded tracers only need to be hidden
+  const float Now = GetWorld()->GetTimeSeconds();
+  bool bHidden = false;
+  for (int32 Slot = 0; Slot < TracerCapacity; Slot++)
+  {
+    if (EndTimes[Slot] >= 0.f && Now >= EndTimes[Slot])
+    {
+      HideSlot(Slot);
+      bHidden = true;
+    }
+  }
+
+  // One render state update for every tracer hidden this frame
+  if (bHidden)
+  {
+    TracerComponent->MarkRenderStateDirty();
+  }
+}
+
+TStatId UTracerSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UTracerSubsystem, STATGROUP_Tickables);
+}
+
+bool UTracerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UTracerSubsystem::AddTracer(const FVector &Start, const FVector &End, const FLinearColor &Color, float Width)
+{
+  if (!IsValid(TracerComponent))
+    return false;
+
+  const FVector Segment = End - Start;
+  const float Length = Segment.Size();
+  if (Length <= KINDA_SMALL_NUMBER)
+    return true;
+
+  // Overwrites the oldest tracer when every slot is in use
+  const int32 Slot = NextSlot;
+  NextSlot = (NextSlot + 1) % TracerCapacity;
+  if (EndTimes[Slot] < 0.f)
+  {
+    NumActive++;
+  }
+
+  const float SpawnTime = GetWorld()->GetTimeSeconds();
+  const float Lifetime = FMath::Max(CVarTracerLifetime.GetValueOnGameThread(), KINDA_SMALL_NUMBER);
+  EndTimes[Slot] = SpawnTime + Lifetime;
+
+  const FTransform TracerTransform(Segment.Rotation(), Start, FVector(Length, Width, Width));
+  TracerComponent->UpdateInstanceTransform(Slot, TracerTransform, true, false, true);
+
+  // Marks the render state dirty once for both updates
+  const float CustomData[NumCustomData] = {SpawnTime, Lifetime, Color.A, Color.R, Color.G, Color.B};
+  TracerComponent->SetCustomData(Slot, CustomData, true);
+
+  return true;
+}
+
+void UTracerSubsystem::HideSlot(int32 Slot)
+{
+  EndTimes[Slot] = -1.f;
+  NumActive--;
+
+  TracerComponent->UpdateInstanceTransform(Slot, FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), true, false, true);
+}
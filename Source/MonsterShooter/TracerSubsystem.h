@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TracerSubsystem.generated.h"
+
+/**
+ * Draws every bullet tracer of the world as one instanced static mesh. Tracers live in a fixed ring buffer
+ * of instances, the oldest one is overwritten when it is full. The material fades each tracer from its per instance
+ * custom data (spawn time, lifetime, opacity, then color), so instances are only updated when a tracer is added
+ * or hidden once faded
+ */
+UCLASS()
+class MONSTERSHOOTER_API UTracerSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  virtual void OnWorldBeginPlay(UWorld &InWorld) override;
+  virtual void Deinitialize() override;
+  virtual void Tick(float DeltaTime) override;
+  virtual TStatId GetStatId() const override;
+
+  /** Adds a tracer from Start to End, returns false when there is no tracer mesh to draw it with */
+  bool AddTracer(const FVector &Start, const FVector &End, const FLinearColor &Color, float Width);
+
+  /** If the tracer mesh was loaded, false on dedicated servers */
+  FORCEINLINE bool CanDrawTracers() const { return TracerComponent != nullptr; }
+
+protected:
+  virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+  /** Hides the instance of a ring buffer slot, without marking the render state dirty */
+  void HideSlot(int32 Slot);
+
+  /** Number of tracers drawn at the same time */
+  static constexpr int32 TracerCapacity = 256;
+
+  /** Floats of custom data per instance, spawn time, lifetime, opacity and RGB color */
+  static constexpr int32 NumCustomData = 6;
+
+  UPROPERTY()
+  class UInstancedStaticMeshComponent *TracerComponent;
+
+  /** World time each slot is faded out at, negative when the slot is free */
+  float EndTimes[TracerCapacity];
+
+  /** Slot the next tracer is written to */
+  int32 NextSlot = 0;
+
+  /** Number of slots still fading */
+  int32 NumActive = 0;
+};
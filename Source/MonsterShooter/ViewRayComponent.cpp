@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ViewRayComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Math/VectorRegister.h"
+
+// Sets default values for this component's properties
+UViewRayComponent::UViewRayComponent() : RayOrigin(FVector::ZeroVector),
+                                         RayDirection(FVector::ForwardVector),
+                                         RayRight(FVector::RightVector),
+                                         RayUp(FVector::UpVector),
+                                         ScreenDistance(1.f),
+                                         bValidRay(false)
+{
+  PrimaryComponentTick.bCanEverTick = true;
+  // Cameras are updated after all the regular tick groups, right before PostUpdateWork
+  PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+void UViewRayComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+  Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+  UpdateViewRay();
+}
+
+void UViewRayComponent::UpdateViewRay()
+{
+  APawn *Pawn = Cast<APawn>(GetOwner());
+  APlayerController *PlayerController = Pawn ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+
+  if (!PlayerController || !PlayerController->PlayerCameraManager)
+  {
+    bValidRay = false;
+    return;
+  }
+
+  int32 ViewportSizeX;
+  int32 ViewportSizeY;
+  PlayerController->GetViewportSize(ViewportSizeX, ViewportSizeY);
+
+  const APlayerCameraManager *CameraManager = PlayerController->PlayerCameraManager;
+  const FRotationMatrix CameraAxes{CameraManager->GetCameraRotation()};
+  const float HalfFOVRadians = FMath::DegreesToRadians(CameraManager->GetFOVAngle() * 0.5f);
+
+  RayOrigin = CameraManager->GetCameraLocation();
+  RayDirection = CameraAxes.GetUnitAxis(EAxis::X);
+  RayRight = CameraAxes.GetUnitAxis(EAxis::Y);
+  RayUp = CameraAxes.GetUnitAxis(EAxis::Z);
+  // Horizontal FOV spans the viewport width
+  ScreenDistance = (ViewportSizeX * 0.5f) / FMath::Max(FMath::Tan(HalfFOVRadians), KINDA_SMALL_NUMBER);
+  bValidRay = ViewportSizeX > 0 && ViewportSizeY > 0;
+}
+
+FVector UViewRayComponent::GetDirectionAtScreenOffset(const FVector2D &ScreenOffset) const
+{
+  // Screen Y grows downward
+  return (RayDirection * ScreenDistance + RayRight * ScreenOffset.X - RayUp * ScreenOffset.Y).GetSafeNormal();
+}
+
+void UViewRayComponent::GetDirectionsInScreenCircle(float Radius, int32 Count, TArray<FVector> &OutDirections) const
+{
+  OutDirections.SetNumUninitialized(Count);
+
+  // Camera axes splatted once, rays are built 4 at a time with one axis per register
+  const VectorRegister4Float ForwardX = VectorSetFloat1(static_cast<float>(RayDirection.X * ScreenDistance));
+  const VectorRegister4Float ForwardY = VectorSetFloat1(static_cast<float>(RayDirection.Y * ScreenDistance));
+  const VectorRegister4Float ForwardZ = VectorSetFloat1(static_cast<float>(RayDirection.Z * ScreenDistance));
+  const VectorRegister4Float RightX = VectorSetFloat1(static_cast<float>(RayRight.X));
+  const VectorRegister4Float RightY = VectorSetFloat1(static_cast<float>(RayRight.Y));
+  const VectorRegister4Float RightZ = VectorSetFloat1(static_cast<float>(RayRight.Z));
+  // Screen Y grows downward
+  const VectorRegister4Float DownX = VectorSetFloat1(static_cast<float>(-RayUp.X));
+  const VectorRegister4Float DownY = VectorSetFloat1(static_cast<float>(-RayUp.Y));
+  const VectorRegister4Float DownZ = VectorSetFloat1(static_cast<float>(-RayUp.Z));
+  const VectorRegister4Float RadiusSquared = VectorSetFloat1(Radius * Radius);
+
+  for (int32 First = 0; First < Count; First += 4)
+  {
+    // Uniform points in the circle, like FMath::RandPointInCircle without the rejection loop
+    alignas(16) float Areas[4];
+    alignas(16) float Angles[4];
+    for (int32 Lane = 0; Lane < 4; Lane++)
+    {
+      Areas[Lane] = FMath::FRand();
+      Angles[Lane] = FMath::FRand() * UE_TWO_PI;
+    }
+
+    const VectorRegister4Float Distance = VectorSqrt(VectorMultiply(VectorLoadAligned(Areas), RadiusSquared));
+    const VectorRegister4Float AngleRegister = VectorLoadAligned(Angles);
+    VectorRegister4Float Sin;
+    VectorRegister4Float Cos;
+    VectorSinCos(&Sin, &Cos, &AngleRegister);
+    const VectorRegister4Float OffsetX = VectorMultiply(Distance, Cos);
+    const VectorRegister4Float OffsetY = VectorMultiply(Distance, Sin);
+
+    // Forward * ScreenDistance + Right * OffsetX - Up * OffsetY, then normalized
+    VectorRegister4Float DirX = VectorMultiplyAdd(OffsetY, DownX, VectorMultiplyAdd(OffsetX, RightX, ForwardX));
+    VectorRegister4Float DirY = VectorMultiplyAdd(OffsetY, DownY, VectorMultiplyAdd(OffsetX, RightY, ForwardY));
+    VectorRegister4Float DirZ = VectorMultiplyAdd(OffsetY, DownZ, VectorMultiplyAdd(OffsetX, RightZ, ForwardZ));
+    const VectorRegister4Float InvLength = VectorReciprocalSqrt(
+        VectorMultiplyAdd(DirZ, DirZ, VectorMultiplyAdd(DirY, DirY, VectorMultiply(DirX, DirX))));
+    DirX = VectorMultiply(DirX, InvLength);
+    DirY = VectorMultiply(DirY, InvLength);
+    DirZ = VectorMultiply(DirZ, InvLength);
+
+    alignas(16) float OutX[4];
+    alignas(16) float OutY[4];
+    alignas(16) float OutZ[4];
+    VectorStoreAligned(DirX, OutX);
+    VectorStoreAligned(DirY, OutY);
+    VectorStoreAligned(DirZ, OutZ);
+
+    const int32 NumLanes = FMath::Min(4, Count - First);
+    for (int32 Lane = 0; Lane < NumLanes; Lane++)
+    {
+      OutDirections[First + Lane] = FVector(OutX[Lane], OutY[Lane], OutZ[Lane]);
+    }
+  }
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ViewRayComponent.generated.h"
+
+/**
+ * Caches the ray going through the crosshair once per frame, after the camera update,
+ * so aim traces don't query the viewport and deproject the screen on every call
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MONSTERSHOOTER_API UViewRayComponent : public UActorComponent
+{
+  GENERATED_BODY()
+
+public:
+  // Sets default values for this component's properties
+  UViewRayComponent();
+
+  // Called every frame, after the camera has been updated
+  virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+  /** Refreshes the cached ray from the owning player's camera */
+  void UpdateViewRay();
+
+  /** Direction of the ray going through a point offset from the crosshair, in screen pixels */
+  FVector GetDirectionAtScreenOffset(const FVector2D &ScreenOffset) const;
+
+  /** Directions of Count rays through random points of a circle around the crosshair, Radius in screen pixels */
+  void GetDirectionsInScreenCircle(float Radius, int32 Count, TArray<FVector> &OutDirections) const;
+
+private:
+  /** World location the view ray starts from */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "View Ray", meta = (AllowPrivateAccess = "true"))
+  FVector RayOrigin;
+
+  /** Direction of the ray going through the crosshair */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "View Ray", meta = (AllowPrivateAccess = "true"))
+  FVector RayDirection;
+
+  /** Camera right and up axes, used to offset the ray in screen space */
+  FVector RayRight;
+  FVector RayUp;
+
+  /** Distance from the eye to the screen plane, in pixels */
+  float ScreenDistance;
+
+  /** True once the ray has been computed from a valid camera */
+  bool bValidRay;
+
+public:
+  FORCEINLINE const FVector &GetRayOrigin() const { return RayOrigin; }
+  FORCEINLINE const FVector &GetRayDirection() const { return RayDirection; }
+  FORCEINLINE bool HasValidRay() const { return bValidRay; }
+};
@@ -7,7 +7,16 @@ AWeapon::AWeapon() : ThrowWeaponTime(0.7f),
                      WeaponType(EWeaponType::EWT_SubmachineGun),
                      ReloadMontageSection(FName(TEXT("Reload SMG"))),
                      ClipBoneName(TEXT("smg_clip")),
-                     bAutomatic(true)
+                     bAutomatic(true),
+                     TracerColor(FLinearColor::White),
+                     TracerWidth(1.f),
+                     MaxRange(50'000.f),
+                     MaxPenetrations(0),
+                     PenetrationDamageFalloff(0.6f),
+                     MaxRicochets(0),
+                     RicochetMaxAngle(20.f),
+                     RicochetDamageFactor(0.5f),
+                     PelletCount(1)
 {
   PrimaryActorTick.bCanEverTick = true;
 }
@@ -66,6 +75,12 @@ void AWeapon::OnConstruction(const FTransform &Transform)
     case EWeaponType::EWT_Uzi:
       WeaponDataRow = WeaponTableObject->FindRow<FWeaponProperties>(FName("Uzi"), TEXT(""));
       break;
+    case EWeaponType::EWT_GrenadeLauncher:
+      WeaponDataRow = WeaponTableObject->FindRow<FWeaponProperties>(FName("GrenadeLauncher"), TEXT(""));
+      break;
+    case EWeaponType::EWT_Shotgun:
+      WeaponDataRow = WeaponTableObject->FindRow<FWeaponProperties>(FName("Shotgun"), TEXT(""));
+      break;
     }
 
     if (WeaponDataRow)
@@ -92,6 +107,8 @@ void AWeapon::OnConstruction(const FTransform &Transform)
       FireRate = WeaponDataRow->FireRate;
       MuzzleFlash = WeaponDataRow->MuzzleFlash;
       FireSound = WeaponDataRow->FireSound;
+      FireLoopSound = WeaponDataRow->FireLoopSound;
+      FireTailSound = WeaponDataRow->FireTailSound;
       AimFireMontageSection = WeaponDataRow->AimFireMontageSection;
       HipFireMontageSection = WeaponDataRow->HipFireMontageSection;
       bAutomatic = WeaponDataRow->bAutomatic;
@@ -99,8 +116,18 @@ void AWeapon::OnConstruction(const FTransform &Transform)
       WeakspotDamage = WeaponDataRow->WeakspotDamage;
       Accuracy = WeaponDataRow->Accuracy;
       BeamParticles = WeaponDataRow->BeamParticles;
+      TracerColor = WeaponDataRow->TracerColor;
+      TracerWidth = WeaponDataRow->TracerWidth;
       Stability = WeaponDataRow->Stability;
       BalanceDamage = WeaponDataRow->BalanceDamage;
+      MaxRange = WeaponDataRow->MaxRange;
+      MaxPenetrations = WeaponDataRow->MaxPenetrations;
+      PenetrationDamageFalloff = WeaponDataRow->PenetrationDamageFalloff;
+      MaxRicochets = WeaponDataRow->MaxRicochets;
+      RicochetMaxAngle = WeaponDataRow->RicochetMaxAngle;
+      RicochetDamageFactor = WeaponDataRow->RicochetDamageFactor;
+      PelletCount = WeaponDataRow->PelletCount;
+      ProjectileProperties = WeaponDataRow->Projectile;
     }
 
     if (GetMaterialInstance())
@@ -125,18 +152,32 @@ void AWeapon::Tick(float DeltaTime)
   }
 }
 
-void AWeapon::ConsumeAmmo()
+void AWeapon::ConsumeAmmo(int32 Amount)
 {
-  if (Ammo - 1 <= 0)
+  if (Ammo - Amount <= 0)
   {
     Ammo = 0;
   }
   else
   {
-    --Ammo;
+    Ammo -= Amount;
   }
 }
 
+int32 AWeapon::ConsumeFireTime(float &FireTimeAccumulator) const
+{
+  if (FireRate <= 0.f)
+  {
+    FireTimeAccumulator = 0.f;
+    return 1;
+  }
+
+  const int32 RoundsDue = FMath::FloorToInt32(FireTimeAccumulator / FireRate);
+  FireTimeAccumulator -= RoundsDue * FireRate;
+
+  return RoundsDue;
+}
+
 void AWeapon::ReloadAmmo(int32 Amount)
 {
   checkf(Ammo + Amount <= MagazineCapacity, TEXT("Attempted to reload with more than magazine capacity"));
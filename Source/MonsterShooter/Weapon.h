@@ -9,6 +9,46 @@
 #include "Engine/DataTable.h"
 #include "Weapon.generated.h"
 
+USTRUCT(BlueprintType)
+struct FProjectileProperties
+{
+  GENERATED_BODY()
+
+  /** Launch speed, weapons with no speed are hitscan */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float Speed = 0.f;
+
+  /** Multiplier of the world gravity, 0 flies straight */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float GravityScale = 1.f;
+
+  /** Fraction of the velocity lost per second */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float Drag = 0.f;
+
+  /** Time after which the projectile detonates on its own */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float Lifetime = 5.f;
+
+  /** Damage dealt in the center of the explosion */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float ExplosionDamage = 0.f;
+
+  /** Radius of the explosion, no radial damage when 0 */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float ExplosionRadius = 0.f;
+
+  /** Particles following the projectile in flight */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  class UParticleSystem *TrailParticles = nullptr;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  UParticleSystem *ExplosionParticles = nullptr;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  class USoundCue *ExplosionSound = nullptr;
+};
+
 USTRUCT(BlueprintType)
 struct FWeaponProperties : public FTableRowBase
 {
@@ -71,6 +111,14 @@ struct FWeaponProperties : public FTableRowBase
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   USoundCue *FireSound;
 
+  /** Looping cue played while an automatic weapon keeps firing, FireSound only plays for the first round */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  USoundCue *FireLoopSound;
+
+  /** Played once when the fire loop stops */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  USoundCue *FireTailSound;
+
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   FName AimFireMontageSection;
 
@@ -92,11 +140,44 @@ struct FWeaponProperties : public FTableRowBase
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   UParticleSystem *BeamParticles;
 
+  /** Color of the instanced tracer, used instead of BeamParticles when the tracer renderer is available */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FLinearColor TracerColor = FLinearColor::White;
+
+  /** Width scale of the instanced tracer */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float TracerWidth = 1.f;
+
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   float Stability;
 
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   float BalanceDamage;
+
+  // Rows saved before this column existed get the default range
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float MaxRange = 50'000.f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  int32 MaxPenetrations = 0;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float PenetrationDamageFalloff = 0.6f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  int32 MaxRicochets = 0;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float RicochetMaxAngle = 20.f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float RicochetDamageFactor = 0.5f;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FProjectileProperties Projectile;
+
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  int32 PelletCount = 1;
 };
 
 /**
@@ -183,6 +264,14 @@ private:
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
   USoundCue *FireSound;
 
+  /** Looping sound played while an automatic weapon keeps firing */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  USoundCue *FireLoopSound;
+
+  /** Sound played when the fire loop stops */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  USoundCue *FireTailSound;
+
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
   FName AimFireMontageSection;
 
@@ -208,6 +297,14 @@ private:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
   UParticleSystem *BeamParticles;
 
+  /** Color of the bullet tracer */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  FLinearColor TracerColor;
+
+  /** Width scale of the bullet tracer */
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  float TracerWidth;
+
   /** How much aim stability the weapon provides. Higher values makes the aim move less, up to no movement at 100.f */
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
   float Stability;
@@ -216,6 +313,38 @@ private:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
   float BalanceDamage;
 
+  /** Maximum distance a shot is traced to */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  float MaxRange;
+
+  /** How many enemies a bullet can go through */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  int32 MaxPenetrations;
+
+  /** Damage multiplier applied each time a bullet goes through an enemy */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  float PenetrationDamageFalloff;
+
+  /** How many times a bullet can bounce off surfaces */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  int32 MaxRicochets;
+
+  /** Largest angle between the shot and the surface, in degrees, that makes the bullet bounce */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  float RicochetMaxAngle;
+
+  /** Damage multiplier applied on each bounce */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  float RicochetDamageFactor;
+
+  /** Number of pellets each round fires, each one deals the weapon damage */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  int32 PelletCount;
+
+  /** Projectile fired by the weapon, hitscan when its speed is 0 */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data Table", meta = (AllowPrivateAccess = "true"))
+  FProjectileProperties ProjectileProperties;
+
 public:
   // Adds impulse to the thrown Weapon
   void ThrowWeapon();
@@ -223,7 +352,10 @@ public:
   FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
   FORCEINLINE int32 GetAmmo() const { return Ammo; }
   /** Called from Character class when firing weapon */
-  void ConsumeAmmo();
+  void ConsumeAmmo(int32 Amount = 1);
+
+  /** Returns how many rounds are due for the accumulated fire time, leaving the remainder in FireTimeAccumulator */
+  int32 ConsumeFireTime(float &FireTimeAccumulator) const;
 
   FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; }
   FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; }
@@ -232,6 +364,10 @@ public:
   FORCEINLINE float GetFireRate() const { return FireRate; }
   FORCEINLINE UParticleSystem *GetMuzzleFlash() const { return MuzzleFlash; }
   FORCEINLINE USoundCue *GetFireSound() const { return FireSound; }
+  FORCEINLINE USoundCue *GetFireLoopSound() const { return FireLoopSound; }
+  FORCEINLINE USoundCue *GetFireTailSound() const { return FireTailSound; }
+  /** Automatic weapons with a loop cue play one looping sound instead of a sound per round */
+  FORCEINLINE bool UsesFireLoop() const { return bAutomatic && FireLoopSound != nullptr; }
   FORCEINLINE FName GetAimFireMontageSection() const { return AimFireMontageSection; }
   FORCEINLINE FName GetHipFireMontageSection() const { return HipFireMontageSection; }
   FORCEINLINE bool GetAutomatic() const { return bAutomatic; }
@@ -239,8 +375,19 @@ public:
   FORCEINLINE float GetWeakspotDamage() const { return WeakspotDamage; }
   FORCEINLINE float GetAccuracy() const { return Accuracy; }
   FORCEINLINE UParticleSystem *GetBeamParticles() const { return BeamParticles; }
+  FORCEINLINE const FLinearColor &GetTracerColor() const { return TracerColor; }
+  FORCEINLINE float GetTracerWidth() const { return TracerWidth; }
   FORCEINLINE float GetStability() const { return Stability; }
   FORCEINLINE float GetBalanceDamage() const { return BalanceDamage; }
+  FORCEINLINE float GetMaxRange() const { return MaxRange; }
+  FORCEINLINE int32 GetMaxPenetrations() const { return MaxPenetrations; }
+  FORCEINLINE float GetPenetrationDamageFalloff() const { return PenetrationDamageFalloff; }
+  FORCEINLINE int32 GetMaxRicochets() const { return MaxRicochets; }
+  FORCEINLINE float GetRicochetMaxAngle() const { return RicochetMaxAngle; }
+  FORCEINLINE float GetRicochetDamageFactor() const { return RicochetDamageFactor; }
+  FORCEINLINE const FProjectileProperties &GetProjectileProperties() const { return ProjectileProperties; }
+  FORCEINLINE bool IsProjectileWeapon() const { return ProjectileProperties.Speed > 0.f; }
+  FORCEINLINE int32 GetPelletCount() const { return FMath::Max(1, PelletCount); }
 
   void ReloadAmmo(int32 Amount);
 
@@ -8,6 +8,8 @@ enum class EWeaponType : uint8
   EWT_Pistol UMETA(DisplayName = "Pistol"),
   EWT_Uzi UMETA(DisplayName = "Uzi"),
   EWT_AK47 UMETA(DisplayName = "AK47"),
+  EWT_GrenadeLauncher UMETA(DisplayName = "GrenadeLauncher"),
+  EWT_Shotgun UMETA(DisplayName = "Shotgun"),
 
   EWT_MAX UMETA(DisplayName = "DefaultMax")
 };
\ No newline at end of file